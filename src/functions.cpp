@@ -1,339 +1,651 @@
 #include "functions.hpp"
 #include <boost/graph/connected_components.hpp>
-#include <boost/graph/depth_first_search.hpp>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+/**
+  @brief Return an estimate of the bytes held by a memo entry
+
+  @param[in] key    Key of the entry
+  @param[in] keys   Number of copies of the key
+  @param[in] values Number of values of the entry (e.g. signed characters)
+  @param[in] size   Size of a value
+
+  @return Estimated size of the entry, in bytes
+*/
+size_t entry_bytes(const std::string& key, const size_t keys,
+                   const size_t values, const size_t size) {
+  return 4 * sizeof(void*) + keys * (sizeof(std::string) + key.capacity()) +
+         values * (2 * sizeof(void*) + size);
+}
 
-//=============================================================================
-// Auxiliary structs and classes
+/**
+  @brief Return an estimate of the bytes held by an entry of a count table
+
+  @param[in] key Key of the entry
 
-initial_state_visitor::initial_state_visitor()
-    : m_safe_sources{}, m_sources{}, chain{}, source_v{}, last_v{} {}
-
-initial_state_visitor::initial_state_visitor(std::list<HDVertex>& safe_sources,
-                                             std::list<HDVertex>& sources)
-    : m_safe_sources{&safe_sources},
-      m_sources{&sources},
-      chain{},
-      source_v{},
-      last_v{} {
-  m_safe_sources->clear();
-  m_sources->clear();
+  @return Estimated size of the entry, in bytes
+*/
+size_t count_entry_bytes(const std::string& key) {
+  return entry_bytes(key, 1, 0, 0) + sizeof(ReductionCount);
 }
 
-void initial_state_visitor::initialize_vertex(const HDVertex v,
-                                              const HDGraph& hasse) const {}
+/**
+  @brief Return \e a + \e b, or the largest size_t if the sum overflows
 
-void initial_state_visitor::start_vertex(const HDVertex v,
-                                         const HDGraph& hasse) {
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: start_vertex: [ ";
+  @param[in] a Count
+  @param[in] b Count
 
-    for (const auto& kk : hasse[v].species) {
-      std::cout << kk << " ";
-    }
+  @return Saturated sum
+*/
+size_t add_counts(const size_t a, const size_t b) {
+  const auto max = std::numeric_limits<size_t>::max();
+
+  return (a > max - b ? max : a + b);
+}
+
+/**
+  @brief Return \e a * \e b, or the largest size_t if the product overflows
+
+  @param[in] a Count
+  @param[in] b Count
+
+  @return Saturated product
+*/
+size_t multiply_counts(const size_t a, const size_t b) {
+  const auto max = std::numeric_limits<size_t>::max();
+
+  if (a == 0 || b == 0) return 0;
+
+  return (a > max / b ? max : a * b);
+}
 
-    std::cout << "]" << std::endl;
+/**
+  @brief Remove every entry from the count table \e memo
+
+  @param[in,out] memo Count table
+*/
+void forget(ReductionCountMap& memo) {
+  for (const auto& entry : memo) {
+    memory_budget().release(count_entry_bytes(entry.first));
   }
 
-  source_v = v;
+  memo.clear();
+}
+
+/**
+  @brief Store \e count in the count table \e memo
+
+  The table is emptied when the memory budget is exceeded.
 
-  chain.clear();
+  @param[in,out] memo  Count table
+  @param[in]     key   Key of the counted graph
+  @param[in]     count Counts of the successful reductions of the graph
+*/
+void memoize(ReductionCountMap& memo, const std::string& key,
+             const ReductionCount& count) {
+  if (!memo.emplace(key, count).second) return;
+
+  memory_budget().acquire(count_entry_bytes(key));
+
+  if (!memory_budget().exceeded()) return;
+
+  memory_budget().evictions += memo.size();
+  forget(memo);
 }
 
-void initial_state_visitor::discover_vertex(const HDVertex v,
-                                            const HDGraph& hasse) {
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: discover_vertex: [ ";
+/**
+  @brief Write \e reduction to \e os, preceded by its length
 
-    for (const auto& kk : hasse[v].species) {
-      std::cout << kk << " ";
-    }
+  @param[in] os        Output stream
+  @param[in] reduction List of signed characters
+*/
+void write_reduction(std::ostream& os,
+                     const std::list<SignedCharacter>& reduction) {
+  os << reduction.size();
+
+  for (const auto& sc : reduction) {
+    os << " " << sc;
+  }
+}
+
+/**
+  @brief Read \e reduction from \e is, preceded by its length
 
-    std::cout << "]" << std::endl;
+  @param[in]  is        Input stream
+  @param[out] reduction List of signed characters
+
+  @return True if the reduction was read
+*/
+bool read_reduction(std::istream& is, std::list<SignedCharacter>& reduction) {
+  size_t length;
+  if (!(is >> length)) return false;
+
+  for (size_t i = 0; i < length; ++i) {
+    std::string token;
+    if (!(is >> token) || token.size() < 2) return false;
+
+    const auto sign = token.back();
+    if (sign != '+' && sign != '-') return false;
+
+    token.pop_back();
+    reduction.push_back({token, (sign == '+' ? State::gain : State::lose)});
   }
 
-  last_v = v;
+  return true;
 }
 
-void initial_state_visitor::examine_edge(const HDEdge e, const HDGraph& hasse) {
-  HDVertex vs, vt;
-  std::tie(vs, vt) = incident(e, hasse);
+/**
+  @brief Write a checkpoint of the search, if the last one is older than
+         checkpoint::interval seconds
+*/
+void checkpoint_periodically() {
+  static auto last = std::chrono::steady_clock::now();
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: examine_edge: [ ";
+  if (checkpoint::file.empty()) return;
 
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
-    }
+  const auto now = std::chrono::steady_clock::now();
 
-    std::cout << "] -";
+  if (now - last < std::chrono::seconds(checkpoint::interval)) return;
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+  save_checkpoint(checkpoint::file);
+  last = now;
+}
+}  // namespace
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
-    }
+//=============================================================================
+// Auxiliary structs and classes
 
-    std::cout << "-> [ ";
+bool TranspositionTable::find(
+    const std::string& key,
+    std::pair<std::list<SignedCharacter>, bool>& result) const {
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
-    }
+  const auto entry = m_table.find(key);
 
-    std::cout << "]" << std::endl;
-  }
+  if (entry == m_table.cend()) return false;
 
-  // add edge to the chain
-  chain.push_back(e);
+  result = entry->second;
+
+  return true;
 }
 
-void initial_state_visitor::tree_edge(const HDEdge e,
-                                      const HDGraph& hasse) const {
-  if (logging::enabled) {
-    // verbosity enabled
-    HDVertex vs, vt;
-    std::tie(vs, vt) = incident(e, hasse);
+void TranspositionTable::insert(
+    const std::string& key,
+    const std::pair<std::list<SignedCharacter>, bool>& result) {
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-    std::cout << "DFS: tree_edge: [ ";
+  if (!m_table.emplace(key, result).second) return;
 
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
-    }
+  m_order.push_back(key);
 
-    std::cout << "] -";
+  // the key is stored in the table and in the insertion order
+  const auto bytes =
+      entry_bytes(key, 2, result.first.size(), sizeof(SignedCharacter));
+  m_bytes += bytes;
+  memory_budget().acquire(bytes);
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+  evict();
+}
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
-    }
+size_t TranspositionTable::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
 
-    std::cout << "-> [ ";
+  return m_table.size();
+}
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
-    }
+void TranspositionTable::clear() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  m_table.clear();
+  m_order.clear();
+
+  memory_budget().release(m_bytes);
+  m_bytes = 0;
+}
+
+std::list<std::pair<std::string, std::pair<std::list<SignedCharacter>, bool>>>
+TranspositionTable::entries() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::list<
+      std::pair<std::string, std::pair<std::list<SignedCharacter>, bool>>>
+      output;
 
-    std::cout << "]" << std::endl;
+  for (const auto& key : m_order) {
+    output.emplace_back(key, m_table.at(key));
   }
 
-  // ignore
+  return output;
 }
 
-void initial_state_visitor::back_edge(const HDEdge e,
-                                      const HDGraph& hasse) const {
-  if (logging::enabled) {
-    // verbosity enabled
-    HDVertex vs, vt;
-    std::tie(vs, vt) = incident(e, hasse);
+void TranspositionTable::evict() {
+  while (memory_budget().exceeded() && !m_order.empty()) {
+    // the oldest graphs are the closest to the root, the least likely to be
+    // reached again
+    const auto entry = m_table.find(m_order.front());
 
-    std::cout << "DFS: back_edge: [ ";
+    const auto bytes = entry_bytes(entry->first, 2, entry->second.first.size(),
+                                   sizeof(SignedCharacter));
+    m_bytes -= bytes;
+    memory_budget().release(bytes);
+    memory_budget().evictions++;
 
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
+    m_table.erase(entry);
+    m_order.pop_front();
+  }
+}
+
+void MemoryBudget::acquire(const size_t bytes) {
+  const size_t used = (m_used += bytes);
+
+  // update the peak, unless another thread raised it further
+  size_t peak = m_peak;
+  while (used > peak && !m_peak.compare_exchange_weak(peak, used)) {
+  }
+}
+
+void MemoryBudget::release(const size_t bytes) { m_used -= bytes; }
+
+MemoryReservation::MemoryReservation(const size_t bytes) : m_bytes(bytes) {
+  memory_budget().acquire(m_bytes);
+}
+
+MemoryReservation::~MemoryReservation() { memory_budget().release(m_bytes); }
+
+ReductionEnumerator::ReductionEnumerator(const RBGraph& g)
+    : m_start{}, m_path{}, m_reduction{} {
+  Pending start;
+  start.g = std::make_unique<RBGraph>();
+  copy_graph(g, *start.g);
+  start.cm = MaximalCharacters(*start.g);
+
+  m_start.push_back(std::move(start));
+}
+
+bool ReductionEnumerator::next(std::list<SignedCharacter>& reduction) {
+  if (!m_started) {
+    m_started = true;
+
+    if (descend(m_start)) {
+      // g has a single reduction, with no branching point
+      reduction = m_reduction;
+
+      return true;
     }
+  }
 
-    std::cout << "] -";
+  while (!m_path.empty()) {
+    auto& frame = m_path.back();
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+    if (frame.sources.empty()) {
+      // every branch of the top branching point was enumerated
+      m_path.pop_back();
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
+      continue;
     }
 
-    std::cout << "-> [ ";
+    auto sc = std::move(frame.sources.front());
+    frame.sources.pop_front();
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
+    m_reduction.resize(frame.prefix);
+
+    std::list<Pending> pending;
+
+    if (frame.sources.empty()) {
+      // last branch, the residual graphs are not needed anymore
+      pending = std::move(frame.pending);
+      m_path.pop_back();
+    } else {
+      for (const auto& kk : frame.pending) {
+        Pending copy;
+        copy.g = std::make_unique<RBGraph>();
+        copy_graph(*kk.g, *copy.g);
+        copy.cm = kk.cm;
+
+        pending.push_back(std::move(copy));
+      }
     }
 
-    std::cout << "]" << std::endl;
+    // realize the characters of the safe source in the first residual graph
+    auto& first = pending.front();
+    std::tie(sc, std::ignore) = realize(sc, *first.g);
+    update_maximal_characters(first.cm, sc, *first.g);
+
+    m_reduction.splice(m_reduction.end(), sc);
+
+    if (descend(pending)) {
+      reduction = m_reduction;
+
+      return true;
+    }
   }
 
-  // ignore
+  return false;
 }
 
-void initial_state_visitor::forward_or_cross_edge(const HDEdge e,
-                                                  const HDGraph& hasse) {
-  HDVertex vs, vt;
-  std::tie(vs, vt) = incident(e, hasse);
+bool ReductionEnumerator::descend(std::list<Pending>& pending) {
+  while (!pending.empty()) {
+    auto& g = *pending.front().g;
+    auto& cm = pending.front().cm;
 
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: forward_or_cross_edge: [ ";
+    remove_singletons(g);
 
-    for (const auto& kk : hasse[vs].species) {
-      std::cout << kk << " ";
-    }
+    if (is_empty(g)) {
+      // the first residual graph is reduced
+      pending.pop_front();
 
-    std::cout << "] -";
+      continue;
+    }
 
-    auto jj = hasse[e].signedcharacters.cbegin();
-    for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
-      std::cout << *jj;
+    RBVertexIMap i_map, c_map;
+    RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
 
-      if (std::next(jj) != hasse[e].signedcharacters.cend()) std::cout << ",";
+    // fill the vertex index map i_assocmap
+    RBVertexIter v, v_end;
+    std::tie(v, v_end) = vertices(g);
+    for (size_t index = 0; v != v_end; ++v, ++index) {
+      boost::put(i_assocmap, *v, index);
     }
 
-    std::cout << "-> [ ";
+    // get number of components and the components map
+    const size_t c_count = boost::connected_components(
+        g, c_assocmap, boost::vertex_index_map(i_assocmap));
 
-    for (const auto& kk : hasse[vt].species) {
-      std::cout << kk << " ";
+    // free characters, then universal characters, are realized as in
+    // try_reduce: they don't branch
+    bool realized = false;
+
+    for (const auto state : {State::lose, State::gain}) {
+      std::tie(v, v_end) = vertices(g);
+      for (; v != v_end; ++v) {
+        if (state == State::lose && !is_free(*v, g, c_map)) continue;
+        if (state == State::gain && !is_universal(*v, g, c_map)) continue;
+
+        std::list<SignedCharacter> lsc;
+        std::tie(lsc, std::ignore) = realize({g[*v].name, state}, g);
+        update_maximal_characters(cm, lsc, g);
+
+        m_reduction.splice(m_reduction.end(), lsc);
+        realized = true;
+
+        break;
+      }
+
+      if (realized) break;
     }
 
-    std::cout << "]" << std::endl;
-  }
+    if (realized) continue;
 
-  if (out_degree(vt, hasse) > 1) {
-    // e is not the last edge in the chain (vt is not a sink in hasse),
-    // ignore it and keep going
-    return;
-  }
+    if (c_count > 1) {
+      // the first residual graph is replaced by its components, in order
+      auto components = connected_components(g, c_map, c_count);
+      const auto cm_g = cm;
 
-  auto v_test = vt;
+      pending.pop_front();
 
-  while (out_degree(v_test, hasse) == 1) {
-    // e is not the last edge in the chain (vt is not a sink in hasse),
-    // but it may be needed for the chain to complete
+      const auto position = pending.begin();
+      for (auto& component : components) {
+        Pending kk;
+        kk.g = std::move(component);
+        kk.cm = cm_g;
 
-    HDOutEdgeIter oe;
-    std::tie(oe, std::ignore) = out_edges(v_test, hasse);
+        pending.insert(position, std::move(kk));
+      }
 
-    // add outedge to the chain
-    chain.push_back(*oe);
+      continue;
+    }
 
-    // update v_test to current vt
-    v_test = target(*oe, hasse);
-  }
+    // the first residual graph branches on its safe sources
+    const auto gm = maximal_reducible_graph(g, cm.characters(g), true);
 
-  perform_test(v_test, hasse);
-}
+    HDGraph p;
 
-void initial_state_visitor::finish_vertex(const HDVertex v,
-                                          const HDGraph& hasse) {
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS: finish_vertex: [ ";
+    if (reduced_hasse::enabled) {
+      hasse_diagram(p, g, gm);
+    } else {
+      hasse_vertices(p, g, gm);
+    }
 
-    for (const auto& kk : hasse[v].species) {
-      std::cout << kk << " ";
+    Frame frame;
+
+    auto sources = initial_states(p);
+    order_sources(sources, p);
+
+    for (const auto& source : sources) {
+      // for each safe source
+      std::list<SignedCharacter> sc;
+
+      for (const auto& ci : p[source].characters) {
+        sc.push_back({ci, State::gain});
+      }
+
+      frame.sources.push_back(sc);
     }
 
-    std::cout << "]" << std::endl;
-  }
+    if (frame.sources.empty())
+      // no safe source, the current reduction fails
+      return false;
 
-  // build list of vertices in chain
-  std::list<HDVertex> chain_v;
-  for (const auto& e : chain) {
-    chain_v.push_back(source(e, hasse));
-  }
+    frame.pending = std::move(pending);
+    frame.prefix = m_reduction.size();
 
-  bool v_in_chain =
-      (std::find(chain_v.cbegin(), chain_v.cend(), v) != chain_v.cend());
+    m_path.push_back(std::move(frame));
 
-  if (out_degree(v, hasse) > 0 || v_in_chain || last_v != v) {
-    // v is not the last vertex in the chain
-    // (which means the visit is backtracking)
-    return;
+    return false;
   }
 
-  perform_test(v, hasse);
+  return true;
 }
 
-void initial_state_visitor::perform_test(const HDVertex v,
-                                         const HDGraph& hasse) {
-  if (m_safe_sources == nullptr || m_sources == nullptr)
-    // uninitialized sources lists
-    return;
+//=============================================================================
+// Enum / Struct operator overloads
+
+std::ostream& operator<<(std::ostream& os, const Strategy& strategy) {
+  if (strategy.random) return os << "random (seed " << strategy.seed << ")";
+
+  if (strategy.nth > 0) return os << "safe source #" << strategy.nth;
+
+  return os << "default";
+}
+
+//=============================================================================
+// Algorithm functions
+
+std::list<HDVertex> initial_states(HDGraph& hasse) {
+  std::list<HDVertex> output;
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "Maximal chains of the Hasse diagram:" << std::endl
+              << std::endl;
+  }
+
+  // sources holds the sources that have a safe chain but failed test 1, which
+  // are the candidates for test 2 and 3
+  std::list<HDVertex> sources;
 
-  // source_v holds the source vertex of the chain
-  // chain holds the list of edges representing the chain
+  ChainEnumerator chains(hasse);
+  HDChain chain;
 
-  // check if source_v is already in m_safe_sources or m_sources
-  if ((!m_safe_sources->empty() && source_v == m_safe_sources->back()) ||
-      (!m_sources->empty() && source_v == m_sources->back())) {
+  while (chains.next(chain)) {
+    // for each maximal chain of the Hasse diagram
     if (logging::enabled) {
       // verbosity enabled
-      std::cout << std::endl
-                << "Chain detected, but its Source has already been processed"
-                << std::endl
-                << std::endl;
+      std::cout << "Chain: [ ";
+
+      for (const auto& kk : hasse[chain.source].species) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << "]";
+
+      for (const auto& e : chain.edges) {
+        std::cout << " -";
+
+        auto jj = hasse[e].signedcharacters.cbegin();
+        for (; jj != hasse[e].signedcharacters.cend(); ++jj) {
+          std::cout << *jj;
+
+          if (std::next(jj) != hasse[e].signedcharacters.cend())
+            std::cout << ",";
+        }
+
+        std::cout << "-> [ ";
+
+        for (const auto& kk : hasse[target(e, hasse)].species) {
+          std::cout << kk << " ";
+        }
+
+        std::cout << "]";
+      }
+
+      std::cout << std::endl;
     }
 
-    return;
-  }
+    // test if chain is a safe chain
+    if (!safe_chain(chain, hasse))
+      // chain is not a safe chain, try the next chain of the same source
+      continue;
 
-  // test if chain is a safe chain
-  if (!safe_chain(v, hasse))
-    // chain is not a safe chain
-    return;
+    // the tests below only depend on the source of the chain, so the other
+    // chains of the same source don't need to be enumerated
+    chains.skip_source();
 
-  if (!realize_source(source_v, hasse))
-    // source_v is not realizable
-    return;
+    if (!realize_source(chain.source, hasse))
+      // the source is not realizable
+      continue;
 
-  // test is source_v is a safe source (for test 1)
-  if (safe_source_test1(hasse)) {
-    // source_v is a safe source, return (don't add it to m_sources)
-    m_safe_sources->push_back(source_v);
+    // test if the source is a safe source (for test 1)
+    if (safe_source_test1(chain.source, hasse)) {
+      // the source is a safe source (don't add it to sources)
+      output.push_back(chain.source);
+
+      if (exponential::enabled || interactive::enabled ||
+          nthsource::index > 0 || randomsource::enabled ||
+          ordering::policy != ordering::Policy::discovery ||
+          ordering::stats) {
+        // exponential algorithm or user interaction enabled
+        // or safe source selection index is not 0 (or random)
+        // or the safe sources are going to be reordered (or counted)
+        if (logging::enabled) {
+          // verbosity enabled
+          std::cout << std::endl
+                    << "Source added to the list of safe sources" << std::endl
+                    << std::endl;
+        }
 
-    if (exponential::enabled || interactive::enabled || nthsource::index > 0) {
-      // exponential algorithm or user interaction enabled
-      // or safe source selection index is not 0
+        continue;
+      }
+
+      // the first safe source is the one that is going to be realized
+      break;
+    }
+
+    // test if the list of safe sources is empty
+    if (!output.empty()) {
+      // list of safe sources is not empty (don't add the source to sources)
       if (logging::enabled) {
         // verbosity enabled
         std::cout << std::endl
-                  << "Source added to the list of safe sources" << std::endl
+                  << "Test 2 and 3 wouldn't be feasible: "
+                  << "the list of safe sources is not empty" << std::endl
                   << std::endl;
       }
 
-      return;
+      continue;
     }
 
-    throw InitialState();
-  }
-
-  // test if the list of safe sources is empty
-  if (!m_safe_sources->empty()) {
-    // list of safe sources is not empty, return (don't add it to m_sources)
     if (logging::enabled) {
       // verbosity enabled
       std::cout << std::endl
-                << "Test 2 and 3 wouldn't be feasible: "
-                << "the list of safe sources is not empty" << std::endl
+                << "Source added to the list of sources" << std::endl
                 << std::endl;
     }
 
-    return;
+    sources.push_back(chain.source);
   }
 
   if (logging::enabled) {
     // verbosity enabled
     std::cout << std::endl
-              << "Source added to the list of sources" << std::endl;
+              << "Maximal chains of the Hasse diagram terminated" << std::endl
+              << std::endl;
+  }
+
+  if (output.empty() && sources.size() == 1) {
+    const auto source = sources.front();
+
+    if (realize_source(source, hasse)) output.push_back(sources.front());
+  } else if (output.empty() && sources.size() > 1) {
+    if (logging::enabled) {
+      // verbosity enabled
+      std::cout << "Sources: < ";
+
+      for (const auto& i : sources) {
+        std::cout << "[ ";
+
+        for (const auto& kk : hasse[i].species) {
+          std::cout << kk << " ";
+        }
+
+        std::cout << "( ";
+
+        for (const auto& kk : hasse[i].characters) {
+          std::cout << kk << " ";
+        }
+
+        std::cout << ") ] ";
+      }
+
+      std::cout << ">" << std::endl << std::endl;
+    }
+
+    output = safe_source_test2(sources, hasse);
+
+    if (output.empty()) output = safe_source_test3(sources, hasse);
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "Safe sources: < ";
+
+    for (const auto& i : output) {
+      std::cout << "[ ";
+
+      for (const auto& kk : hasse[i].species) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << "( ";
+
+      for (const auto& kk : hasse[i].characters) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << ") ] ";
+    }
 
-    if (!chain.empty()) std::cout << std::endl;
+    std::cout << ">" << std::endl << std::endl;
   }
 
-  m_sources->push_back(source_v);
+  return output;
 }
 
-bool initial_state_visitor::safe_chain(const HDVertex v, const HDGraph& hasse) {
+bool safe_chain(const HDChain& chain, const HDGraph& hasse) {
   if (orig_g(hasse) == nullptr || orig_gm(hasse) == nullptr)
     // uninitialized graph properties
     return false;
 
   const auto& gm = *orig_gm(hasse);
 
-  // chain holds the list of edges representing the chain
-
   // test if the chain is empty
-  if (chain.empty()) {
+  if (chain.edges.empty()) {
     if (logging::enabled) {
       // verbosity enabled
       std::cout << std::endl << "Empty chain" << std::endl << std::endl;
@@ -344,20 +656,12 @@ bool initial_state_visitor::safe_chain(const HDVertex v, const HDGraph& hasse) {
 
   std::list<SignedCharacter> lsc;
 
-  for (const auto& c : hasse[source_v].characters) {
+  for (const auto& c : hasse[chain.source].characters) {
     lsc.push_back({c, State::gain});
   }
 
-  for (const auto& e : chain) {
+  for (const auto& e : chain.edges) {
     for (const auto& sc : hasse[e].signedcharacters) {
-      const auto check_sc_in_chain =
-          std::find(hasse[v].characters.cbegin(), hasse[v].characters.cend(),
-                    sc.character);
-
-      if (check_sc_in_chain == hasse[v].characters.cend())
-        // ignore wrong edge (other chain, old edge)
-        break;
-
       const auto check_sc_in_lsc = std::find(lsc.cbegin(), lsc.cend(), sc);
 
       if (check_sc_in_lsc != lsc.cend())
@@ -420,7 +724,7 @@ bool initial_state_visitor::safe_chain(const HDVertex v, const HDGraph& hasse) {
   return output;
 }
 
-bool initial_state_visitor::safe_source_test1(const HDGraph& hasse) {
+bool safe_source_test1(const HDVertex source, const HDGraph& hasse) {
   if (orig_g(hasse) == nullptr || orig_gm(hasse) == nullptr)
     // uninitialized graph properties
     return false;
@@ -434,9 +738,13 @@ bool initial_state_visitor::safe_source_test1(const HDGraph& hasse) {
 
   // search for a species s+ in GRB|CM∪A that consists of C(s) and is connected
   // to only inactive characters
-  for (const auto& species_name : hasse[source_v].species) {
+  for (const auto& species_name : hasse[source].species) {
+    if (vertex_map(gm).count(species_name) == 0)
+      // species collapsed into another species of source
+      continue;
+
     const auto source_s = get_vertex(species_name, gm);
-    // for each source species (s+) in source_v
+    // for each source species (s+) in source
     bool active = false;
 
     // check if s+ is connected to active characters
@@ -472,110 +780,6 @@ bool initial_state_visitor::safe_source_test1(const HDGraph& hasse) {
   return false;
 }
 
-//=============================================================================
-// Algorithm functions
-
-std::list<HDVertex> initial_states(const HDGraph& hasse) {
-  std::list<HDVertex> output;
-
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "DFS visit on the Hasse diagram:" << std::endl << std::endl;
-  }
-
-  // the visitor continuosly modifies the sources variable (passed as reference)
-  // in search of safe chains and sources. At the end of the visit, sources
-  // holds the list of sources of the Hasse diagram.
-  std::list<HDVertex> sources;
-  initial_state_visitor vis(output, sources);
-
-  std::map<HDVertex, size_t> i_map;
-  for(auto v : boost::make_iterator_range(vertices(hasse)))
-    i_map.emplace(v, i_map.size());
-  
-  
-  auto ipmap = boost::make_assoc_property_map(i_map);
-  
-  std::vector<boost::default_color_type> c_map(num_vertices(hasse));
-  auto cpmap = boost::make_iterator_property_map(c_map.begin(), ipmap);
-
-  
-  
-
-  try {
-    depth_first_search(hasse, 
-                      boost::visitor(vis)
-                      .vertex_index_map(ipmap)
-                      .color_map(cpmap));
-  } catch (const InitialState& e) {
-  }
-
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << std::endl
-              << "DFS visit on the Hasse diagram terminated" << std::endl
-              << std::endl;
-  }
-
-  if (output.empty() && sources.size() == 1) {
-    const auto source = sources.front();
-
-    if (realize_source(source, hasse)) output.push_back(sources.front());
-  } else if (output.empty() && sources.size() > 1) {
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "Sources: < ";
-
-      for (const auto& i : sources) {
-        std::cout << "[ ";
-
-        for (const auto& kk : hasse[i].species) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << "( ";
-
-        for (const auto& kk : hasse[i].characters) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << ") ] ";
-      }
-
-      std::cout << ">" << std::endl << std::endl;
-    }
-
-    output = safe_source_test2(sources, hasse);
-
-    if (output.empty()) output = safe_source_test3(sources, hasse);
-  }
-
-  if (logging::enabled) {
-    // verbosity enabled
-    std::cout << "Safe sources: < ";
-
-    for (const auto& i : output) {
-      std::cout << "[ ";
-
-      for (const auto& kk : hasse[i].species) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << "( ";
-
-      for (const auto& kk : hasse[i].characters) {
-        std::cout << kk << " ";
-      }
-
-      std::cout << ") ] ";
-    }
-
-    std::cout << ">" << std::endl << std::endl;
-  }
-
-  return output;
-}
-
 std::list<HDVertex> safe_source_test2(const std::list<HDVertex>& sources,
                                       const HDGraph& hasse) {
   std::list<HDVertex> output;
@@ -676,9 +880,13 @@ std::list<HDVertex> safe_source_test2(const std::list<HDVertex>& sources,
 
     if (output.empty()) continue;
 
-    if (exponential::enabled || interactive::enabled || nthsource::index > 0) {
+    if (exponential::enabled || interactive::enabled ||
+        nthsource::index > 0 || randomsource::enabled ||
+        ordering::policy != ordering::Policy::discovery ||
+        ordering::stats) {
       // exponential algorithm or user interaction enabled
-      // or safe source selection index is not 0
+      // or safe source selection index is not 0 (or random)
+      // or the safe sources are going to be reordered (or counted)
       if (logging::enabled) {
         // verbosity enabled
         std::cout << std::endl
@@ -724,6 +932,10 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
 
     // make sure every species s+ is connected to active characters
     for (const auto& species_name : hasse[source].species) {
+      if (vertex_map(gm).count(species_name) == 0)
+        // species collapsed into another species of source
+        continue;
+
       const auto source_s = get_vertex(species_name, gm);
       // for each source species (s+) in source
       size_t active_count = 0;
@@ -796,9 +1008,13 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
 
     output.push_back(source);
 
-    if (exponential::enabled || interactive::enabled || nthsource::index > 0) {
+    if (exponential::enabled || interactive::enabled ||
+        nthsource::index > 0 || randomsource::enabled ||
+        ordering::policy != ordering::Policy::discovery ||
+        ordering::stats) {
       // exponential algorithm or user interaction enabled
-      // or safe source selection index is not 0
+      // or safe source selection index is not 0 (or random)
+      // or the safe sources are going to be reordered (or counted)
       if (logging::enabled) {
         // verbosity enabled
         std::cout << std::endl
@@ -890,6 +1106,115 @@ bool realize_source(const HDVertex source, const HDGraph& hasse) {
   return output;
 }
 
+void order_sources(std::list<HDVertex>& sources, const HDGraph& hasse) {
+  if (ordering::policy == ordering::Policy::discovery || sources.size() < 2)
+    // the safe sources are kept in the order they were found
+    return;
+
+  const auto& g = *orig_g(hasse);
+
+  // priority of each safe source, the highest first
+  std::vector<std::pair<HDVertex, long>> priorities;
+
+  for (const auto& source : sources) {
+    long priority = 0;
+
+    switch (ordering::policy) {
+      case ordering::Policy::characters:
+        // most characters first
+        priority = hasse[source].characters.size();
+        break;
+
+      case ordering::Policy::active: {
+        // fewest active characters first
+        std::set<std::string> active_c;
+
+        for (const auto& kk : hasse[source].species) {
+          if (vertex_map(g).count(kk) == 0)
+            // species collapsed into another species of source
+            continue;
+
+          RBOutEdgeIter e, e_end;
+          std::tie(e, e_end) = out_edges(get_vertex(kk, g), g);
+          for (; e != e_end; ++e) {
+            if (is_red(*e, g)) active_c.insert(g[target(*e, g)].name);
+          }
+        }
+
+        priority = -static_cast<long>(active_c.size());
+        break;
+      }
+
+      case ordering::Policy::reduction: {
+        // largest number of vertices removed by the realization first
+        RBGraph g_test;
+        copy_graph(g, g_test);
+
+        std::list<SignedCharacter> sc;
+        for (const auto& ci : hasse[source].characters) {
+          sc.push_back({ci, State::gain});
+        }
+
+        // the realizations are only a measure, they aren't logged
+        const auto logging_enabled = logging::enabled;
+        logging::enabled = false;
+
+        realize(sc, g_test);
+
+        logging::enabled = logging_enabled;
+
+        priority = num_vertices(g) - num_vertices(g_test);
+        break;
+      }
+
+      default:
+        break;
+    }
+
+    priorities.push_back(std::make_pair(source, priority));
+  }
+
+  std::stable_sort(
+      priorities.begin(), priorities.end(),
+      [](const std::pair<HDVertex, long>& a,
+         const std::pair<HDVertex, long>& b) { return a.second > b.second; });
+
+  sources.clear();
+
+  for (const auto& kk : priorities) {
+    sources.push_back(kk.first);
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "Ordered safe sources: < ";
+
+    for (const auto& source : sources) {
+      std::cout << "[ ";
+
+      for (const auto& kk : hasse[source].species) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << "( ";
+
+      for (const auto& kk : hasse[source].characters) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << ") ] ";
+    }
+
+    std::cout << ">" << std::endl << std::endl;
+  }
+}
+
+OrderingStats& ordering_stats() {
+  static OrderingStats stats;
+
+  return stats;
+}
+
 bool is_partial(const std::list<SignedCharacter>& reduction) {
   std::list<std::string> gained_c{};
 
@@ -911,95 +1236,486 @@ bool is_partial(const std::list<SignedCharacter>& reduction) {
   return false;
 }
 
-//=============================================================================
-// Algorithm main functions
+std::list<std::string> update_maximal_characters(
+    MaximalCharacters& cm, const std::list<SignedCharacter>& lsc,
+    const RBGraph& g) {
+  std::list<std::string> changed;
+  for (const auto& sc : lsc) {
+    changed.push_back(sc.character);
+  }
 
-std::list<SignedCharacter> reduce(RBGraph& g) {
-  std::list<SignedCharacter> output;
+  const auto output = cm.update(changed, g);
 
-  if (logging::enabled) {
+  if (logging::enabled && !output.empty()) {
     // verbosity enabled
-    std::cout << std::endl
-              << "Working on the red-black graph G" << std::endl
-              << "Adjacency lists:" << std::endl
-              << g << std::endl
-              << std::endl;
+    std::cout << "New maximal characters: { ";
+
+    for (const auto& kk : output) {
+      std::cout << kk << " ";
+    }
+
+    std::cout << "}" << std::endl;
   }
 
-  // cleanup graph from dead vertices
-  // TODO: check if this is needed (realize already does this?)
-  remove_singletons(g);
+  return output;
+}
 
-  if (is_empty(g)) {
-    // if graph is empty
-    // return the empty sequence
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "G empty" << std::endl << std::endl;
+ReductionResult reduce_source(const HDVertex source, const HDGraph& hasse,
+                              const RBGraph& g, const MaximalCharacters& cm) {
+  RBGraph g_test;
+  copy_graph(g, g_test);
+
+  const MemoryReservation reservation(graph_bytes(g_test));
+
+  MaximalCharacters cm_test(cm);
+
+  return reduce_source_in_place(source, hasse, g_test, cm_test);
+}
+
+ReductionResult reduce_source_in_place(const HDVertex source,
+                                       const HDGraph& hasse, RBGraph& g,
+                                       MaximalCharacters& cm) {
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "Current safe source: [ ";
+
+    for (const auto& kk : hasse[source].species) {
+      std::cout << kk << " ";
     }
 
-    // return < >
-    return output;
+    std::cout << "( ";
+
+    for (const auto& kk : hasse[source].characters) {
+      std::cout << kk << " ";
+    }
+
+    std::cout << ") ]" << std::endl << std::endl;
+  }
+
+  // realize the characters of the safe source
+  std::list<SignedCharacter> sc;
+
+  for (const auto& ci : hasse[source].characters) {
+    sc.push_back({ci, State::gain});
   }
 
   if (logging::enabled) {
     // verbosity enabled
-    std::cout << "G not empty" << std::endl;
-  }
+    std::cout << "Realize the characters < ";
 
-  RBVertexIMap i_map, c_map;
-  RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
+    for (const auto& kk : sc) {
+      std::cout << kk << " ";
+    }
 
-  // fill the vertex index map i_assocmap
-  RBVertexIter v, v_end;
-  std::tie(v, v_end) = vertices(g);
-  for (size_t index = 0; v != v_end; ++v, ++index) {
-    boost::put(i_assocmap, *v, index);
+    std::cout << "> in G" << std::endl;
   }
 
-  // get number of components and the components map
-  const size_t c_count = boost::connected_components(
-      g, c_assocmap, boost::vertex_index_map(i_assocmap));
+  std::tie(sc, std::ignore) = realize(sc, g);
+  update_maximal_characters(cm, sc, g);
 
-  // realize free characters in the graph
-  // TODO: check if this is needed (realize already does this?)
-  std::tie(v, v_end) = vertices(g);
-  for (; v != v_end; ++v) {
-    // for each vertex
-    if (is_free(*v, g, c_map)) {
-      // if v is free
-      // realize v-
-      // return < v-, reduce(g) >
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "G free character " << g[*v].name << std::endl;
+  std::list<SignedCharacter> rest;
+  bool success;
+  std::tie(rest, success) = try_reduce(g, cm);
+
+  if (success) {
+    if (logging::enabled) {
+      // verbosity enabled
+      std::cout << "Ok for safe source [ ";
+
+      for (const auto& kk : hasse[source].species) {
+        std::cout << kk << " ";
       }
 
-      std::list<SignedCharacter> lsc;
-      std::tie(lsc, std::ignore) = realize({g[*v].name, State::lose}, g);
+      std::cout << "( ";
 
-      output.splice(output.cend(), lsc);
-      output.splice(output.cend(), reduce(g));
+      for (const auto& kk : hasse[source].characters) {
+        std::cout << kk << " ";
+      }
 
-      // return < v-, reduce(g) >
-      return output;
+      std::cout << ") ]" << std::endl << std::endl;
     }
+
+    // append the recursive call to the current source's output
+    sc.splice(sc.end(), rest);
+
+    return std::make_pair(sc, true);
   }
 
   if (logging::enabled) {
     // verbosity enabled
-    std::cout << "G no free characters" << std::endl;
-  }
+    std::cout << "No for safe source [ ";
 
-  // realize universal characters in the graph
-  // TODO: check if this is needed (realize already does this?)
-  std::tie(v, v_end) = vertices(g);
-  for (; v != v_end; ++v) {
-    // for each vertex
-    if (is_universal(*v, g, c_map)) {
-      // if v is universal
-      // realize v+
-      // return < v+, reduce(g) >
+    for (const auto& kk : hasse[source].species) {
+      std::cout << kk << " ";
+    }
+
+    std::cout << "( ";
+
+    for (const auto& kk : hasse[source].characters) {
+      std::cout << kk << " ";
+    }
+
+    std::cout << ") ]" << std::endl << std::endl;
+  }
+
+  return std::make_pair(std::list<SignedCharacter>{}, false);
+}
+
+ThreadPool& branch_pool() {
+  // started on first use, after the options have been parsed
+  static ThreadPool pool(parallel::threads);
+
+  return pool;
+}
+
+TranspositionTable& transposition_table() {
+  // every thread has its own table, so the instances reduced at the same time
+  // don't share their graphs
+  static thread_local TranspositionTable table;
+
+  return (branch_table() != nullptr ? *branch_table() : table);
+}
+
+TranspositionTable*& branch_table() {
+  static thread_local TranspositionTable* table = nullptr;
+
+  return table;
+}
+
+MemoryBudget& memory_budget() {
+  static MemoryBudget budget;
+
+  return budget;
+}
+
+std::list<CheckpointFrame>& checkpoint_frames() {
+  static std::list<CheckpointFrame> frames;
+
+  return frames;
+}
+
+std::list<CheckpointFrame>& resume_frames() {
+  static std::list<CheckpointFrame> frames;
+
+  return frames;
+}
+
+void save_checkpoint(const std::string& filename) {
+  const auto entries = transposition_table().entries();
+
+  // the previous checkpoint is replaced only once the new one is complete
+  const auto temporary = filename + ".tmp";
+  std::ofstream file(temporary);
+
+  if (!file) {
+    // output file can't be created
+    throw std::runtime_error(
+        "Failed to write checkpoint to file: permission denied");
+  }
+
+  size_t graphs = 0;
+  for (const auto& entry : entries) {
+    // the empty graph has an empty fingerprint
+    if (!entry.first.empty()) graphs++;
+  }
+
+  file << "checkpoint " << checkpoint_frames().size() << " " << graphs
+       << std::endl;
+
+  for (const auto& frame : checkpoint_frames()) {
+    file << frame.graph << " " << frame.index << " " << frame.outputs.size()
+         << std::endl;
+
+    for (const auto& output : frame.outputs) {
+      write_reduction(file, output);
+      file << std::endl;
+    }
+  }
+
+  for (const auto& entry : entries) {
+    if (entry.first.empty()) continue;
+
+    file << entry.first << " " << entry.second.second << " ";
+    write_reduction(file, entry.second.first);
+    file << std::endl;
+  }
+
+  file.close();
+
+  if (!file || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+    throw std::runtime_error(
+        "Failed to write checkpoint to file: " + filename);
+  }
+}
+
+void load_checkpoint(const std::string& filename) {
+  std::ifstream file(filename);
+
+  if (!file) {
+    // input file doesn't exist
+    throw std::runtime_error(
+        "Failed to read checkpoint from file: no such file or directory");
+  }
+
+  std::string header;
+  size_t num_frames, num_graphs;
+
+  if (!(file >> header >> num_frames >> num_graphs) ||
+      header != "checkpoint") {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read checkpoint from file: badly formatted header");
+  }
+
+  std::list<CheckpointFrame> frames;
+  for (size_t i = 0; i < num_frames; ++i) {
+    CheckpointFrame frame;
+    size_t num_outputs;
+
+    if (!(file >> frame.graph >> frame.index >> num_outputs)) {
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read checkpoint from file: badly formatted choice");
+    }
+
+    for (size_t j = 0; j < num_outputs; ++j) {
+      std::list<SignedCharacter> output;
+
+      if (!read_reduction(file, output)) {
+        // input file parsing error
+        throw std::runtime_error(
+            "Failed to read checkpoint from file: badly formatted reduction");
+      }
+
+      frame.outputs.push_back(output);
+    }
+
+    frames.push_back(frame);
+  }
+
+  for (size_t i = 0; i < num_graphs; ++i) {
+    std::string key;
+    ReductionResult result;
+
+    if (!(file >> key >> result.second) || !read_reduction(file, result.first)) {
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read checkpoint from file: badly formatted graph");
+    }
+
+    transposition_table().insert(key, result);
+  }
+
+  resume_frames().splice(resume_frames().cend(), frames);
+}
+
+const CancellationToken*& branch_cancellation() {
+  static thread_local const CancellationToken* token = nullptr;
+
+  return token;
+}
+
+BranchPath& branch_path() {
+  static thread_local BranchPath path;
+
+  return path;
+}
+
+SharedHashSet*& shared_failures() {
+  static SharedHashSet* failures = nullptr;
+
+  return failures;
+}
+
+//=============================================================================
+// Algorithm main functions
+
+std::list<SignedCharacter> reduce(RBGraph& g) {
+  MaximalCharacters cm(g);
+
+  return reduce(g, cm);
+}
+
+std::list<SignedCharacter> reduce(RBGraph& g, MaximalCharacters& cm) {
+  std::list<SignedCharacter> output;
+  bool success;
+  std::tie(output, success) = try_reduce(g, cm);
+
+  if (!success)
+    // g can't be reduced
+    throw NoReduction();
+
+  return output;
+}
+
+ReductionResult try_reduce(RBGraph& g) {
+  MaximalCharacters cm(g);
+
+  return try_reduce(g, cm);
+}
+
+ReductionResult try_reduce(RBGraph& g, MaximalCharacters& cm) {
+  if (branch_cancelled())
+    // a previous branch was successful (first success mode)
+    return std::make_pair(std::list<SignedCharacter>{}, false);
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << std::endl
+              << "Working on the red-black graph G" << std::endl
+              << "Adjacency lists:" << std::endl
+              << g << std::endl
+              << std::endl;
+  }
+
+  // cleanup graph from dead vertices
+  // TODO: check if this is needed (realize already does this?)
+  remove_singletons(g);
+
+  RBVertexIMap i_map, c_map;
+  RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
+
+  // fill the vertex index map i_assocmap
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (size_t index = 0; v != v_end; ++v, ++index) {
+    boost::put(i_assocmap, *v, index);
+  }
+
+  // get number of components and the components map
+  const size_t c_count = boost::connected_components(
+      g, c_assocmap, boost::vertex_index_map(i_assocmap));
+
+  if (!exponential::enabled) return try_reduce(g, cm, c_map, c_count);
+
+  // the exponential algorithm reaches the same residual graphs through
+  // different orders of the safe sources
+  const auto key = fingerprint(g);
+
+  ReductionResult output;
+
+  if (transposition_table().find(key, output)) {
+    if (logging::enabled) {
+      // verbosity enabled
+      std::cout << "G found in the transposition table: "
+                << (output.second ? "reducible" : "not reducible") << std::endl
+                << std::endl;
+    }
+
+    if (output.second) {
+      // g is reduced to the empty graph, as if it was reduced again
+      RBVertexIter next;
+      std::tie(v, v_end) = vertices(g);
+      for (next = v; v != v_end; v = next) {
+        next++;
+        clear_vertex(*v, g);
+        remove_vertex(*v, g);
+      }
+    }
+
+    return output;
+  }
+
+  // the failures of the other workers are stored as two independent hashes of
+  // the fingerprint: a graph mistaken for a failed one would make a branch
+  // fail, so both hashes must match (about 2^-128 chances of a collision)
+  if (shared_failures() != nullptr &&
+      shared_failures()->contains(SharedHashSet::key(key))) {
+    if (logging::enabled) {
+      // verbosity enabled
+      std::cout << "G found in the shared failures: not reducible" << std::endl
+                << std::endl;
+    }
+
+    return std::make_pair(std::list<SignedCharacter>{}, false);
+  }
+
+  const auto consumed = branch_path().consumed;
+
+  output = try_reduce(g, cm, c_map, c_count);
+
+  // a failure caused by a cancellation says nothing about g, and neither does
+  // the outcome of a search restricted to a branch path
+  if (branch_path().consumed != consumed) return output;
+
+  if (output.second || !branch_cancelled())
+    transposition_table().insert(key, output);
+
+  if (!output.second && !branch_cancelled() && shared_failures() != nullptr)
+    shared_failures()->insert(SharedHashSet::key(key));
+
+  return output;
+}
+
+ReductionResult try_reduce(RBGraph& g, MaximalCharacters& cm,
+                           const RBVertexIMap& c_map, const size_t c_count) {
+  std::list<SignedCharacter> output;
+
+  if (is_empty(g)) {
+    // if graph is empty
+    // return the empty sequence
+    if (logging::enabled) {
+      // verbosity enabled
+      std::cout << "G empty" << std::endl << std::endl;
+    }
+
+    // return < >
+    return std::make_pair(output, true);
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "G not empty" << std::endl;
+  }
+
+  // realize free characters in the graph
+  // TODO: check if this is needed (realize already does this?)
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    // for each vertex
+    if (is_free(*v, g, c_map)) {
+      // if v is free
+      // realize v-
+      // return < v-, reduce(g) >
+      if (logging::enabled) {
+        // verbosity enabled
+        std::cout << "G free character " << g[*v].name << std::endl;
+      }
+
+      std::list<SignedCharacter> lsc;
+      std::tie(lsc, std::ignore) = realize({g[*v].name, State::lose}, g);
+      update_maximal_characters(cm, lsc, g);
+
+      output.splice(output.cend(), lsc);
+
+      std::list<SignedCharacter> rest;
+      bool success;
+      std::tie(rest, success) = try_reduce(g, cm);
+
+      if (!success) return std::make_pair(std::list<SignedCharacter>{}, false);
+
+      output.splice(output.cend(), rest);
+
+      // return < v-, reduce(g) >
+      return std::make_pair(std::move(output), true);
+    }
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "G no free characters" << std::endl;
+  }
+
+  // realize universal characters in the graph
+  // TODO: check if this is needed (realize already does this?)
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    // for each vertex
+    if (is_universal(*v, g, c_map)) {
+      // if v is universal
+      // realize v+
+      // return < v+, reduce(g) >
       if (logging::enabled) {
         // verbosity enabled
         std::cout << "G universal character " << g[*v].name << std::endl;
@@ -1007,12 +1723,20 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
 
       std::list<SignedCharacter> lsc;
       std::tie(lsc, std::ignore) = realize({g[*v].name, State::gain}, g);
+      update_maximal_characters(cm, lsc, g);
 
       output.splice(output.cend(), lsc);
-      output.splice(output.cend(), reduce(g));
+
+      std::list<SignedCharacter> rest;
+      bool success;
+      std::tie(rest, success) = try_reduce(g, cm);
+
+      if (!success) return std::make_pair(std::list<SignedCharacter>{}, false);
+
+      output.splice(output.cend(), rest);
 
       // return < v+, reduce(g) >
-      return output;
+      return std::make_pair(std::move(output), true);
     }
   }
 
@@ -1027,11 +1751,19 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
     // build subgraphs (connected components) g1, g2, etc.
     // return < reduce(g1), reduce(g2), ... >
     for (const auto& component : components) {
-      output.splice(output.cend(), reduce(*component.get()));
+      std::list<SignedCharacter> rest;
+      bool success;
+      std::tie(rest, success) = try_reduce(*component.get(), cm);
+
+      if (!success)
+        // a component can't be reduced, neither can g
+        return std::make_pair(std::list<SignedCharacter>{}, false);
+
+      output.splice(output.cend(), rest);
     }
 
     // return < reduce(g1), reduce(g2), ... >
-    return output;
+    return std::make_pair(std::move(output), true);
   }
 
   if (logging::enabled) {
@@ -1040,7 +1772,29 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
   }
 
   // gm = Grb|Cm∪A, maximal reducible graph of g (Grb)
-  const auto gm = maximal_reducible_graph(g, true);
+  const auto cm_g = cm.characters(g);
+
+  bool is_maximal_reducible = true;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (is_inactive(*v, g) && !cm.is_maximal(g[*v].name)) {
+      is_maximal_reducible = false;
+
+      break;
+    }
+  }
+
+  // if every inactive character of g is maximal (e.g. on the first call after
+  // the --maximal preprocessing), g is already its own maximal reducible graph
+  // and doesn't need to be copied
+  const RBGraph gm_copy = (is_maximal_reducible
+                               ? RBGraph()
+                               : maximal_reducible_graph(g, cm_g, true));
+
+  const RBGraph& gm = (is_maximal_reducible ? g : gm_copy);
+
+  const MemoryReservation gm_reservation(
+      is_maximal_reducible ? 0 : graph_bytes(gm_copy));
 
   if (logging::enabled) {
     // verbosity enabled
@@ -1054,12 +1808,24 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
 
   // p = Hasse diagram for gm (Grb|Cm∪A)
   HDGraph p;
-  hasse_diagram(p, g, gm);
-  
+
+  if (reduced_hasse::enabled) {
+    // removing the active species needs the whole diagram
+    hasse_diagram(p, g, gm);
+  } else {
+    // cover relations are built as the search for safe chains descends the
+    // diagram, starting from its sources
+    hasse_vertices(p, g, gm);
+  }
 
   if (logging::enabled) {
     // verbosity enabled
-    std::cout << "Hasse diagram for the subgraph Gm" << std::endl
+    std::cout << "Hasse diagram for the subgraph Gm";
+
+    if (p[boost::graph_bundle].lazy)
+      std::cout << " (cover relations are built on demand)";
+
+    std::cout << std::endl
               << "Adjacency lists:" << std::endl
               << p << std::endl
               << std::endl;
@@ -1070,9 +1836,44 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
 
   if (s.empty())
     // p has no safe source
-    throw NoReduction();
+    return std::make_pair(std::list<SignedCharacter>{}, false);
+
+  order_sources(s, p);
+
+  if (branch_path().probe) {
+    // only the safe sources of the first choice are needed (sharded search)
+    if (branch_path().consumed++ == 0) branch_path().width = s.size();
+
+    return std::make_pair(std::list<SignedCharacter>{}, false);
+  }
+
+  if (!branch_path().indices.empty()) {
+    // the choice is restricted to one safe source (sharded search)
+    const auto index = branch_path().indices.front();
+    branch_path().indices.pop_front();
+    branch_path().consumed++;
+
+    if (index >= s.size()) {
+      // the branch path leads nowhere
+      branch_path().overflow = true;
+
+      return std::make_pair(std::list<SignedCharacter>{}, false);
+    }
+
+    s = {*std::next(s.cbegin(), index)};
+  }
+
+  // record if the first safe source of a choice leads to a successful reduction
+  auto record_choice = [&s](const bool success) {
+    if (s.size() < 2) return;
+
+    ordering_stats().choices++;
+
+    if (success) ordering_stats().successes++;
+  };
 
   HDVertex source = 0;
+  bool first_choice = false;
   std::list<SignedCharacter> sc;
 
   // exponential safe source selection
@@ -1080,94 +1881,158 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
     // exponential algorithm enabled
     std::list<std::list<SignedCharacter>> sources_output;
 
-    for (const auto& source : s) {
-      // for each safe source in s
-      RBGraph g_test;
-      copy_graph(g, g_test);
+    // over the memory budget, the safe sources are tested one at a time, only
+    // the first successful reduction is kept and the last safe source is
+    // realized in g itself, since g isn't needed after it
+    const bool lean = memory_budget().exceeded();
+
+    if (lean) {
+      memory_budget().lean++;
 
       if (logging::enabled) {
         // verbosity enabled
-        std::cout << "Current safe source: [ ";
-
-        for (const auto& kk : p[source].species) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << "( ";
-
-        for (const auto& kk : p[source].characters) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << ") ]" << std::endl << std::endl;
+        std::cout << "Memory limit exceeded: safe sources tested without "
+                     "copies where possible"
+                  << std::endl
+                  << std::endl;
       }
+    }
 
-      // realize the characters of the safe source
-      sc.clear();
+    if (parallel::threads > 1 && !lean) {
+      // every safe source is a task of the pool; the results are collected in
+      // the order of s
+      std::list<std::future<ReductionResult>> branches;
 
-      for (const auto& ci : p[source].characters) {
-        sc.push_back({ci, State::gain});
+      // one token per branch, cancelled with the branch of the caller
+      std::vector<std::unique_ptr<CancellationToken>> tokens;
+      for (size_t i = 0; i < s.size(); ++i) {
+        tokens.push_back(
+            std::make_unique<CancellationToken>(branch_cancellation()));
       }
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << "Realize the characters < ";
-
-        for (const auto& kk : sc) {
-          std::cout << kk << " ";
-        }
-
-        std::cout << "> in G" << std::endl;
+      // the branches share the transposition table of the caller
+      const auto table = &transposition_table();
+
+      size_t i = 0;
+      for (const auto& source : s) {
+        // for each safe source in s
+        branches.push_back(
+            branch_pool().submit([source, i, table, &tokens, &p, &g, &cm]() {
+              // the branches are reduced without logging, since their output
+              // would be interleaved; the flags are restored because the task
+              // may run on a thread that is waiting for other branches
+              const auto logging_enabled = logging::enabled;
+              const auto cancellation = branch_cancellation();
+              const auto branch = branch_table();
+              logging::enabled = false;
+              branch_cancellation() = tokens[i].get();
+              branch_table() = table;
+
+              const auto output = reduce_source(source, p, g, cm);
+
+              if (output.second && exponential::first_success) {
+                // the following branches can't be the first success
+                for (size_t j = i + 1; j < tokens.size(); ++j) {
+                  tokens[j]->cancel();
+                }
+              }
+
+              logging::enabled = logging_enabled;
+              branch_cancellation() = cancellation;
+              branch_table() = branch;
+
+              return output;
+            }));
+
+        i++;
       }
 
-      std::tie(sc, std::ignore) = realize(sc, g_test);
+      // every branch is waited, since they all refer to this stack frame
+      for (auto& branch : branches) {
+        std::list<SignedCharacter> output;
+        bool success;
+        std::tie(output, success) = branch_pool().wait(branch);
 
-      try {
-        std::list<SignedCharacter> rest = reduce(g_test);
-
-        if (logging::enabled) {
-          // verbosity enabled
-          std::cout << "Ok for safe source [ ";
+        if (&branch == &branches.front()) record_choice(success);
 
-          for (const auto& kk : p[source].species) {
-            std::cout << kk << " ";
-          }
+        if (!success) continue;
 
-          std::cout << "( ";
+        if (exponential::first_success && !sources_output.empty()) continue;
 
-          for (const auto& kk : p[source].characters) {
-            std::cout << kk << " ";
+        sources_output.push_back(output);
+      }
+    } else {
+      // the choice is tracked for the checkpoints: the safe sources tested
+      // before a checkpoint are skipped when the search is resumed
+      const bool tracked =
+          (!checkpoint::file.empty() || !resume_frames().empty());
+      size_t first = 0;
+
+      if (tracked) {
+        CheckpointFrame frame;
+        frame.graph = std::hash<std::string>()(fingerprint(g));
+
+        if (!resume_frames().empty() &&
+            resume_frames().front().graph == frame.graph) {
+          // the choice was in progress in the resumed search
+          frame = std::move(resume_frames().front());
+          resume_frames().pop_front();
+
+          first = frame.index;
+          sources_output = frame.outputs;
+
+          if (logging::enabled) {
+            // verbosity enabled
+            std::cout << "Resumed choice: " << first << " of " << s.size()
+                      << " safe sources already tested" << std::endl
+                      << std::endl;
           }
-
-          std::cout << ") ]" << std::endl << std::endl;
+        } else if (!resume_frames().empty() && checkpoint_frames().empty()) {
+          // the first choice of the search is not the first choice of the
+          // checkpoint
+          throw CheckpointMismatch();
         }
 
-        // append the recursive call to the current source's output
-        sc.splice(sc.end(), rest);
-        sources_output.push_back(sc);
-      } catch (const NoReduction& e) {
-        if (logging::enabled) {
-          // verbosity enabled
-          std::cout << "No for safe source [ ";
+        checkpoint_frames().push_back(frame);
+      }
 
-          for (const auto& kk : p[source].species) {
-            std::cout << kk << " ";
-          }
+      size_t index = 0;
+      for (const auto& source : s) {
+        // for each safe source in s
+        if (index++ < first) continue;
+
+        std::list<SignedCharacter> output;
+        bool success;
+
+        if (lean && source == s.back())
+          std::tie(output, success) = reduce_source_in_place(source, p, g, cm);
+        else
+          std::tie(output, success) = reduce_source(source, p, g, cm);
 
-          std::cout << "( ";
+        if (source == s.front()) record_choice(success);
 
-          for (const auto& kk : p[source].characters) {
-            std::cout << kk << " ";
-          }
+        // over the memory budget only the first successful reduction is kept
+        if (success && (!lean || sources_output.empty()))
+          sources_output.push_back(output);
 
-          std::cout << ") ]" << std::endl << std::endl;
+        if (tracked) {
+          checkpoint_frames().back().index = index;
+          checkpoint_frames().back().outputs = sources_output;
+
+          checkpoint_periodically();
         }
+
+        if (success && exponential::first_success)
+          // the remaining safe sources are not tested
+          break;
       }
+
+      if (tracked) checkpoint_frames().pop_back();
     }
 
     if (sources_output.empty())
       // no realization induces a successful reduction
-      throw NoReduction();
+      return std::make_pair(std::list<SignedCharacter>{}, false);
 
     if (logging::enabled) {
       // verbosity enabled
@@ -1191,7 +2056,7 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
       std::cout << "]" << std::endl << std::endl;
     }
 
-    return sources_output.front();
+    return std::make_pair(sources_output.front(), true);
   }
   // user-input-driven safe source selection
   else if (s.size() > 1 && interactive::enabled) {
@@ -1285,6 +2150,26 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
                 << "========================================" << std::endl
                 << std::endl;
     }
+  } else if (s.size() > 1 && randomsource::enabled) {
+    std::uniform_int_distribution<size_t> distribution(0, s.size() - 1);
+    source = *std::next(s.cbegin(), distribution(randomsource::engine));
+
+    if (logging::enabled) {
+      // verbosity enabled
+      std::cout << "Source [ ";
+
+      for (const auto& kk : p[source].species) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << "( ";
+
+      for (const auto& kk : p[source].characters) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << ") ] selected at random" << std::endl << std::endl;
+    }
   } else if (s.size() > 1 && nthsource::index > 0) {
     if (nthsource::index < s.size())
       source = *std::next(s.cbegin(), nthsource::index);
@@ -1308,9 +2193,11 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
       std::cout << ") ] selected " << std::endl << std::endl;
     }
   }
-  // standard safe source selection (the first one found)
+  // standard safe source selection (the first one found, or the first one in
+  // the order given by the ordering policy)
   else {
     source = s.front();
+    first_choice = true;
   }
 
   sc.clear();
@@ -1332,14 +2219,509 @@ std::list<SignedCharacter> reduce(RBGraph& g) {
 
   // realize the characters of the safe source
   std::tie(sc, std::ignore) = realize(sc, g);
+  update_maximal_characters(cm, sc, g);
 
   // append the list of realized characters and the recursive call to the
   // output in constant time (std::list::splice simply moves pointers around
   // instead of copying the data)
   output.splice(output.cend(), sc);
-  output.splice(output.cend(), reduce(g));
+
+  std::list<SignedCharacter> rest;
+  bool success;
+  std::tie(rest, success) = try_reduce(g, cm);
+
+  if (first_choice) record_choice(success);
+
+  if (!success) return std::make_pair(std::list<SignedCharacter>{}, false);
+
+  output.splice(output.cend(), rest);
 
   // return < sc, reduce(g) >
+  return std::make_pair(std::move(output), true);
+}
+
+ReductionCount count_reductions(RBGraph& g) {
+  MaximalCharacters cm(g);
+
+  return count_reductions(g, cm);
+}
+
+ReductionCount count_reductions(RBGraph& g, MaximalCharacters& cm) {
+  // the active characters of the input graph are never gained
+  std::set<std::string> unpaired;
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (is_active(*v, g)) unpaired.insert(g[*v].name);
+  }
+
+  ReductionCountMap memo;
+
+  const auto output = count_reductions(g, cm, unpaired, memo);
+
+  forget(memo);
+
+  return output;
+}
+
+ReductionCount count_reductions(RBGraph& g, MaximalCharacters& cm,
+                                std::set<std::string> unpaired,
+                                ReductionCountMap& memo) {
+  remove_singletons(g);
+
+  if (is_empty(g))
+    // the empty sequence
+    return ReductionCount(1, 0);
+
+  // the counts depend on g and on the unpaired characters left in g
+  auto key = fingerprint(g);
+  for (const auto& name : unpaired) {
+    if (vertex_map(g).count(name)) key += "|" + name;
+  }
+
+  const auto found = memo.find(key);
+
+  if (found != memo.cend()) {
+    if (logging::enabled) {
+      // verbosity enabled
+      std::cout << "G found in the count table" << std::endl << std::endl;
+    }
+
+    return found->second;
+  }
+
+  // count the reductions of g after the realization of lsc, which is a partial
+  // prefix if it loses an unpaired character
+  auto count_rest = [&memo](const std::list<SignedCharacter>& lsc,
+                            RBGraph& g_rest, MaximalCharacters& cm_rest,
+                            std::set<std::string> unpaired_rest) {
+    bool partial = false;
+
+    for (const auto& sc : lsc) {
+      if (sc.state == State::lose && unpaired_rest.erase(sc.character))
+        partial = true;
+    }
+
+    const auto rest = count_reductions(g_rest, cm_rest, unpaired_rest, memo);
+
+    if (partial) return ReductionCount(0, add_counts(rest.first, rest.second));
+
+    return rest;
+  };
+
+  RBVertexIMap i_map, c_map;
+  RBVertexIAssocMap i_assocmap(i_map), c_assocmap(c_map);
+
+  // fill the vertex index map i_assocmap
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (size_t index = 0; v != v_end; ++v, ++index) {
+    boost::put(i_assocmap, *v, index);
+  }
+
+  // get number of components and the components map
+  const size_t c_count = boost::connected_components(
+      g, c_assocmap, boost::vertex_index_map(i_assocmap));
+
+  // free characters, then universal characters, are realized as in
+  // try_reduce: they don't branch
+  for (const auto state : {State::lose, State::gain}) {
+    std::tie(v, v_end) = vertices(g);
+    for (; v != v_end; ++v) {
+      if (state == State::lose && !is_free(*v, g, c_map)) continue;
+      if (state == State::gain && !is_universal(*v, g, c_map)) continue;
+
+      std::list<SignedCharacter> lsc;
+      std::tie(lsc, std::ignore) = realize({g[*v].name, state}, g);
+      update_maximal_characters(cm, lsc, g);
+
+      const auto output = count_rest(lsc, g, cm, unpaired);
+      memoize(memo, key, output);
+
+      return output;
+    }
+  }
+
+  if (c_count > 1) {
+    // the reductions of g are the combinations of the reductions of its
+    // components
+    ReductionCount output(1, 0);
+
+    const auto components = connected_components(g, c_map, c_count);
+    for (const auto& component : components) {
+      const auto count = count_reductions(*component.get(), cm, unpaired, memo);
+
+      // a combination is partial if any of its reductions is partial
+      output.second = add_counts(
+          multiply_counts(output.second, add_counts(count.first, count.second)),
+          multiply_counts(output.first, count.second));
+      output.first = multiply_counts(output.first, count.first);
+
+      if (output.first == 0 && output.second == 0) break;
+    }
+
+    memoize(memo, key, output);
+
+    return output;
+  }
+
+  // every safe source of g is a branch
+  const auto gm = maximal_reducible_graph(g, cm.characters(g), true);
+
+  const MemoryReservation gm_reservation(graph_bytes(gm));
+
+  HDGraph p;
+
+  if (reduced_hasse::enabled) {
+    hasse_diagram(p, g, gm);
+  } else {
+    hasse_vertices(p, g, gm);
+  }
+
+  ReductionCount output(0, 0);
+
+  const auto sources = initial_states(p);
+
+  // over the memory budget, the last safe source is realized in g itself,
+  // since g isn't needed after it
+  const bool lean = memory_budget().exceeded();
+
+  if (lean) memory_budget().lean++;
+
+  for (const auto& source : sources) {
+    // for each safe source
+    const bool in_place = (lean && source == sources.back());
+
+    RBGraph g_copy;
+    if (!in_place) copy_graph(g, g_copy);
+
+    RBGraph& g_test = (in_place ? g : g_copy);
+
+    const MemoryReservation reservation(in_place ? 0 : graph_bytes(g_test));
+
+    MaximalCharacters cm_test(cm);
+
+    std::list<SignedCharacter> lsc;
+    for (const auto& ci : p[source].characters) {
+      lsc.push_back({ci, State::gain});
+    }
+
+    std::tie(lsc, std::ignore) = realize(lsc, g_test);
+    update_maximal_characters(cm_test, lsc, g_test);
+
+    const auto count = count_rest(lsc, g_test, cm_test, unpaired);
+
+    output.first = add_counts(output.first, count.first);
+    output.second = add_counts(output.second, count.second);
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "Successful reductions of G: " << output.first
+              << " complete, " << output.second << " partial" << std::endl
+              << std::endl;
+  }
+
+  memoize(memo, key, output);
+
+  return output;
+}
+
+ReductionResult try_reduce_sharded(const RBGraph& g, const size_t processes) {
+  // the branches are the safe sources of the first choice of the search, found
+  // by following the search on g up to that choice
+  size_t width;
+
+  {
+    RBGraph g_probe;
+    copy_graph(g, g_probe);
+
+    MaximalCharacters cm(g_probe);
+
+    const auto path = branch_path();
+    const auto logging_enabled = logging::enabled;
+    branch_path() = BranchPath();
+    branch_path().probe = true;
+    logging::enabled = false;
+
+    try_reduce(g_probe, cm);
+
+    width = branch_path().width;
+    branch_path() = path;
+    logging::enabled = logging_enabled;
+  }
+
+  std::vector<std::vector<uint32_t>> paths;
+  for (uint32_t i = 0; i < std::max<size_t>(width, 1); ++i) {
+    paths.push_back({i});
+  }
+
+  // the longest outcome gains and loses every character
+  size_t capacity = 64;
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    capacity += 2 * (g[*v].name.size() + 16);
+  }
+
+  ShardQueue queue(paths, capacity);
+  SharedHashSet failures(1 << 16);
+
+  // the buffered output would be written by the workers too
+  std::cout.flush();
+
+  auto spawn = [&]() {
+    const pid_t pid = fork();
+
+    if (pid != 0) return pid;
+
+    // worker process: the branches are followed without logging
+    logging::enabled = false;
+    shared_failures() = &failures;
+
+    size_t index;
+    while (queue.pop(getpid(), index)) {
+      const auto path = queue.path(index);
+
+      branch_path() = BranchPath();
+      branch_path().indices.assign(path.cbegin(), path.cend());
+
+      RBGraph g_test;
+      copy_graph(g, g_test);
+
+      MaximalCharacters cm(g_test);
+
+      const auto result = try_reduce(g_test, cm);
+
+      // a path that wasn't followed to the end is a duplicate of the first
+      // branch, unless it only chooses the first safe sources
+      bool overflow = branch_path().overflow;
+      for (const auto i : branch_path().indices) {
+        if (i > 0) overflow = true;
+      }
+
+      std::ostringstream outcome;
+
+      if (overflow) {
+        outcome << "overflow";
+      } else if (!result.second) {
+        outcome << "no";
+      } else {
+        outcome << "ok ";
+        write_reduction(outcome, result.first);
+      }
+
+      queue.publish(index, outcome.str());
+    }
+
+    std::cout.flush();
+    _exit(0);
+  };
+
+  std::set<pid_t> workers;
+  for (size_t i = 0; i < std::max<size_t>(processes, 1); ++i) {
+    const pid_t pid = spawn();
+
+    if (pid < 0) throw std::runtime_error("Failed to start a worker process");
+
+    workers.insert(pid);
+  }
+
+  // with --first-success the search ends when the first successful branch
+  // in order is known
+  auto settled = [&queue]() {
+    for (size_t i = 0; i < queue.size(); ++i) {
+      if (queue.state(i) != ShardQueue::done) return false;
+
+      if (queue.outcome(i).compare(0, 2, "ok") == 0) return true;
+    }
+
+    return true;
+  };
+
+  std::vector<size_t> crashes(queue.size(), 0);
+  size_t restarted = 0;
+
+  while (!workers.empty()) {
+    int status;
+    const pid_t pid =
+        waitpid(-1, &status, (exponential::first_success ? WNOHANG : 0));
+
+    if (pid > 0 && workers.erase(pid)) {
+      if (WIFEXITED(status) && WEXITSTATUS(status) == 0) continue;
+
+      // the worker crashed: its branch is queued again, unless it already
+      // crashed a worker
+      for (const auto index : queue.taken_by(pid)) {
+        if (crashes[index]++ == 0)
+          queue.requeue(index);
+        else
+          queue.publish(index, "crashed");
+      }
+
+      const pid_t replacement = spawn();
+
+      if (replacement > 0) {
+        workers.insert(replacement);
+        restarted++;
+      }
+
+      continue;
+    }
+
+    if (pid < 0 && errno != EINTR)
+      // no children left
+      break;
+
+    if (exponential::first_success && settled()) {
+      // the following branches can't be the first success
+      for (const auto worker : workers) {
+        kill(worker, SIGKILL);
+        waitpid(worker, &status, 0);
+      }
+
+      break;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // merge the outcomes in the order of the safe sources
+  std::list<std::list<SignedCharacter>> sources_output;
+  size_t crashed = 0;
+
+  for (size_t i = 0; i < queue.size(); ++i) {
+    if (queue.state(i) != ShardQueue::done) continue;
+
+    const auto outcome = queue.outcome(i);
+
+    if (outcome == "crashed") crashed++;
+
+    if (outcome.compare(0, 2, "ok") != 0) continue;
+
+    std::istringstream istream(outcome.substr(2));
+    std::list<SignedCharacter> output;
+
+    if (read_reduction(istream, output)) sources_output.push_back(output);
+
+    if (exponential::first_success) break;
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    std::cout << "Sharded search: " << sources_output.size()
+              << " successful branches, " << restarted
+              << " workers restarted, " << crashed << " branches crashed"
+              << std::endl;
+
+    std::cout << "Reductions: [" << std::endl;
+
+    for (const auto& lkk : sources_output) {
+      if (is_partial(lkk))
+        std::cout << "  Partial: ";
+      else
+        std::cout << "  Complete: ";
+
+      std::cout << "< ";
+
+      for (const auto& kk : lkk) {
+        std::cout << kk << " ";
+      }
+
+      std::cout << ">" << std::endl;
+    }
+
+    std::cout << "]" << std::endl << std::endl;
+  }
+
+  if (sources_output.empty())
+    // no branch induces a successful reduction
+    return std::make_pair(std::list<SignedCharacter>{}, false);
+
+  return std::make_pair(sources_output.front(), true);
+}
+
+std::vector<Strategy> portfolio_strategies(const size_t count) {
+  std::vector<Strategy> output;
+
+  for (size_t i = 0; i < count; ++i) {
+    Strategy strategy;
+
+    if (i % 2 == 1) {
+      // nth safe source
+      strategy.nth = i / 2 + 1;
+    } else if (i > 0) {
+      // random safe source
+      strategy.random = true;
+      strategy.seed = i / 2;
+    }
+
+    output.push_back(strategy);
+  }
+
+  return output;
+}
+
+ReductionResult try_reduce_portfolio(const RBGraph& g,
+                                     const std::vector<Strategy>& strategies) {
+  ReductionResult output(std::list<SignedCharacter>{}, false);
+
+  std::mutex mutex;
+  size_t winner = strategies.size();
+
+  // one token per strategy, cancelled with the branch of the caller
+  std::vector<std::unique_ptr<CancellationToken>> tokens;
+  for (size_t i = 0; i < strategies.size(); ++i) {
+    tokens.push_back(std::make_unique<CancellationToken>(branch_cancellation()));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < strategies.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      // the selection globals are thread local: each strategy sets its own
+      nthsource::index = strategies[i].nth;
+      randomsource::enabled = strategies[i].random;
+      randomsource::engine.seed(strategies[i].seed);
+      branch_cancellation() = tokens[i].get();
+
+      RBGraph g_test;
+      copy_graph(g, g_test);
+
+      MaximalCharacters cm(g_test);
+
+      auto result = try_reduce(g_test, cm);
+
+      if (!result.second) return;
+
+      std::lock_guard<std::mutex> lock(mutex);
+
+      if (winner < strategies.size())
+        // another strategy was faster
+        return;
+
+      winner = i;
+      output = std::move(result);
+
+      for (size_t j = 0; j < tokens.size(); ++j) {
+        if (j != i) tokens[j]->cancel();
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (logging::enabled) {
+    // verbosity enabled
+    if (winner < strategies.size())
+      std::cout << "Portfolio: " << strategies[winner]
+                << " strategy succeeded first" << std::endl;
+    else
+      std::cout << "Portfolio: no strategy succeeded" << std::endl;
+  }
+
   return output;
 }
 
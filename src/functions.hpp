@@ -1,183 +1,351 @@
 #ifndef FUNCTIONS_HPP
 #define FUNCTIONS_HPP
 
+#include <deque>
+#include <mutex>
+#include <set>
+#include <unordered_map>
 #include "hdgraph.hpp"
+#include "pool.hpp"
 #include "rbgraph.hpp"
+#include "shard.hpp"
 
 //=============================================================================
 // Auxiliary structs and classes
 
 /**
-  @brief Safe chain DFS Visitor exception
+  @brief Reduce exception
 
-  Thrown when \e initial_state_visitor finds a safe chain with a safe source
+  Thrown when \e reduce can't reduce the graph anymore
 */
-class InitialState : public std::exception {
+class NoReduction : public std::exception {
  public:
   /**
     @brief Returns the reason of the exception
 
     @return C String
   */
-  inline const char* what() const throw() { return "Found initial state"; }
+  inline const char* what() const throw() { return "Could not reduce graph"; }
 };
 
 /**
-  @brief Reduce exception
+  @brief Checkpoint exception
 
-  Thrown when \e reduce can't reduce the graph anymore
+  Thrown when the search resumed by --resume doesn't start from the choice
+  saved in the checkpoint, i.e. the checkpoint was saved for another graph
 */
-class NoReduction : public std::exception {
+class CheckpointMismatch : public std::exception {
  public:
   /**
     @brief Returns the reason of the exception
 
     @return C String
   */
-  inline const char* what() const throw() { return "Could not reduce graph"; }
+  inline const char* what() const throw() {
+    return "Failed to read checkpoint from file: saved for another matrix";
+  }
 };
 
 /**
-  @brief DFS Visitor used in depth_first_search
+  @brief Transposition table of the exponential algorithm
+
+  Different orders of the safe sources often lead to the same residual graph:
+  the table stores the outcome of the reduction of a graph, keyed by its
+  fingerprint, so that each residual graph is reduced only once.
+  The table can be used concurrently by the branches of the parallel
+  exponential algorithm.
 */
-class initial_state_visitor : public boost::default_dfs_visitor {
+class TranspositionTable {
  public:
   /**
-    @brief DFS Visitor default constructor
+    @brief Search the outcome of the reduction of the graph \e key
+
+    @param[in]  key    Fingerprint of a red-black graph
+    @param[out] result Realized characters and success flag, if found
+
+    @return True if \e key is in the table
   */
-  initial_state_visitor();
+  bool find(const std::string& key,
+            std::pair<std::list<SignedCharacter>, bool>& result) const;
 
   /**
-    @brief DFS Visitor constructor
+    @brief Store the outcome of the reduction of the graph \e key
 
-    @param[out] safe_sources List of vertices representing the safe sources of
-                             the diagram
-    @param[out] sources      List of vertices representing the maybe-safe
-                             sources of the diagram
+    @param[in] key    Fingerprint of a red-black graph
+    @param[in] result Realized characters and success flag
   */
-  initial_state_visitor(std::list<HDVertex>& safe_sources,
-                        std::list<HDVertex>& sources);
+  void insert(const std::string& key,
+              const std::pair<std::list<SignedCharacter>, bool>& result);
 
   /**
-    @brief Invoked on every vertex of the graph before the start of the graph
-           search
+    @brief Return the number of graphs in the table
 
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+    @return Number of graphs
   */
-  void initialize_vertex(const HDVertex v, const HDGraph& hasse) const;
+  size_t size() const;
 
   /**
-    @brief Invoked on the source vertex once before the start of the search
-
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+    @brief Remove every graph from the table
   */
-  void start_vertex(const HDVertex v, const HDGraph& hasse);
+  void clear();
 
   /**
-    @brief Invoked when a vertex is encountered for the first time
+    @brief Return the graphs in the table, in order of insertion
+
+    @return Fingerprints paired with the outcomes of their reductions
+  */
+  std::list<std::pair<std::string, std::pair<std::list<SignedCharacter>, bool>>>
+  entries() const;
 
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+ private:
+  /**
+    @brief Remove the oldest graphs from the table, while the memory budget is
+           exceeded
   */
-  void discover_vertex(const HDVertex v, const HDGraph& hasse);
+  void evict();
+
+  mutable std::mutex m_mutex{};  ///< Table lock
+  std::unordered_map<std::string, std::pair<std::list<SignedCharacter>, bool>>
+      m_table{};                       ///< Outcomes, keyed by fingerprint
+  std::deque<std::string> m_order{};  ///< Keys, in order of insertion
+  size_t m_bytes = 0;                 ///< Bytes held in the memory budget
+};
+
+/**
+  @brief Struct used to represent a choice of the exponential algorithm in a
+         checkpoint
 
+  A choice is identified by the graph it's made on: its safe sources before
+  \e index have been tested, and \e outputs holds their successful
+  reductions.
+*/
+struct CheckpointFrame {
+  size_t graph = 0;  ///< Hash of the fingerprint of the graph
+  size_t index = 0;  ///< Index of the first safe source left to test
+  std::list<std::list<SignedCharacter>> outputs{};  ///< Reductions so far
+};
+
+/**
+  @brief Struct used to represent the branch path followed by a worker of the
+         sharded search
+
+  The first choices of the exponential algorithm are restricted to the safe
+  sources in \e indices, one per choice.
+  A probe stops the search at its first choice, and records the number of safe
+  sources of the choice in \e width.
+*/
+struct BranchPath {
+  std::list<size_t> indices{};  ///< Safe source indices of the next choices
+  size_t consumed = 0;          ///< Number of restricted choices so far
+  bool overflow = false;        ///< True if an index had no safe source
+  bool probe = false;           ///< True to stop at the first choice
+  size_t width = 0;             ///< Safe sources of the first choice (probe)
+};
+
+/**
+  @brief Memory budget of the search
+
+  Tracks an estimate of the bytes held by the copies of the graph made by the
+  branches of the exponential algorithm and by the memo tables.
+  When the limit (memory::limit) is exceeded the memo tables evict their
+  entries, and the branches stop copying the graph where they can.
+*/
+class MemoryBudget {
+ public:
   /**
-    @brief Invoked on every out-edge of each vertex after it is discovered
+    @brief Add \e bytes to the memory in use
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+    @param[in] bytes Number of bytes
   */
-  void examine_edge(const HDEdge e, const HDGraph& hasse);
+  void acquire(const size_t bytes);
 
   /**
-    @brief Invoked on each edge as it becomes a member of the edges that form
-           the search tree
+    @brief Remove \e bytes from the memory in use
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+    @param[in] bytes Number of bytes
   */
-  void tree_edge(const HDEdge e, const HDGraph& hasse) const;
+  void release(const size_t bytes);
 
   /**
-    @brief Invoked on the back edges in the graph
+    @brief Check if the memory in use exceeds the limit
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+    @return True if there is a limit and it is exceeded
   */
-  void back_edge(const HDEdge e, const HDGraph& hasse) const;
+  bool exceeded() const { return memory::limit > 0 && m_used > memory::limit; }
 
   /**
-    @brief Invoked on forward or cross edges in the graph
+    @brief Return the memory in use
 
-    @param[in] e     Edge
-    @param[in] hasse Hasse diagram graph
+    @return Number of bytes
   */
-  void forward_or_cross_edge(const HDEdge e, const HDGraph& hasse);
+  size_t used() const { return m_used; }
 
   /**
-    @brief Invoked on vertex \e v after finish_vertex has been called for all
-           the vertices in the DFS-tree rooted at vertex \e v
+    @brief Return the largest memory in use so far
+
+    @return Number of bytes
+  */
+  size_t peak() const { return m_peak; }
 
-    If vertex \e v is a leaf in the DFS-tree, then the finish_vertex function
-    is called on \e v after all the out-edges of \e v have been examined.
+  std::atomic<size_t> evictions{0};  ///< Memo entries evicted
+  std::atomic<size_t> lean{0};       ///< Choices made without copies
 
-    @param[in] v     Vertex
-    @param[in] hasse Hasse diagram graph
+ private:
+  std::atomic<size_t> m_used{0};  ///< Bytes in use
+  std::atomic<size_t> m_peak{0};  ///< Largest number of bytes in use
+};
+
+/**
+  @brief Bytes held in the memory budget for the lifetime of the object
+*/
+class MemoryReservation {
+ public:
+  /**
+    @brief Constructor, acquiring \e bytes
+
+    @param[in] bytes Number of bytes
   */
-  void finish_vertex(const HDVertex v, const HDGraph& hasse);
+  MemoryReservation(const size_t bytes);
 
   /**
-    @brief Test if \e chain is a safe chain with \e source_v as source
+    @brief Destructor, releasing the bytes
+  */
+  ~MemoryReservation();
+
+  MemoryReservation(const MemoryReservation&) = delete;
+  MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+ private:
+  const size_t m_bytes;  ///< Bytes held
+};
+
+/**
+  @brief Statistics of the safe source ordering
+
+  A choice is a call of the algorithm with more than one safe source: it is
+  successful if the reduction that starts with the first safe source (in the
+  order given by \e ordering::policy) is successful.
+*/
+struct OrderingStats {
+  std::atomic<size_t> choices{0};    ///< Number of choices
+  std::atomic<size_t> successes{0};  ///< Number of successful first choices
+};
+
+/**
+  @brief Safe source selection strategy of the portfolio solver
+*/
+struct Strategy {
+  size_t nth = 0;       ///< Index of the selected safe source (0 = first)
+  bool random = false;  ///< True if the safe source is selected at random
+  unsigned seed = 0;    ///< Seed of the random selection
+};
 
-    Call \e safe_chain to check if \e chain is a safe chain. If it is, run
-    Test 1 on \e source_v.
-    If Test 1 succeds, add \e source_v to the list of safe sources.
-    If Test 1 fails, add \e source_v to the list of sources (maybe safe).
+/**
+  @brief Lazy enumerator of the successful reductions of a red-black graph
+
+  Reductions are yielded one at a time by \e next, in the depth-first order of
+  the exponential algorithm, each reduction exactly once.
+  The enumeration only holds the branches of the path it is currently on
+  (a copy of the residual graphs and the safe sources left to try, for each
+  branching point), instead of every reduction of every subproblem.
+  Every safe source is a branch, so \e exponential::enabled must be set.
+*/
+class ReductionEnumerator {
+ public:
+  /**
+    @brief Enumerator constructor
 
-    @param[in] v     Current vertex
-    @param[in] hasse Hasse diagram graph
+    @param[in] g Red-black graph, copied by the enumerator
   */
-  void perform_test(const HDVertex v, const HDGraph& hasse);
+  ReductionEnumerator(const RBGraph& g);
 
   /**
-    @brief Check if \e chain is a safe chain in \e hasse
+    @brief Move to the next successful reduction
 
-    Let GRB be a red-black graph, let P be the Hasse diagram for GRB|CM and let
-    C be a chain of P.
-    Then C is safe if the c-reduction S(C) of C is feasible for the graph and
-    applying S(C) to GRB results in a graph that has no red Σ-graphs.
+    @param[out] reduction Next successful reduction, left untouched if there is
+                          none
 
-    @param[in] v     Current vertex
-    @param[in] hasse Hasse diagram graph
+    @return True if a reduction was found, False if the enumeration is over
+  */
+  bool next(std::list<SignedCharacter>& reduction);
+
+ private:
+  /**
+    @brief Residual graph still to be reduced, with its maximal characters
+  */
+  struct Pending {
+    std::unique_ptr<RBGraph> g{};  ///< Residual graph
+    MaximalCharacters cm{};        ///< Maximal characters of g
+  };
 
-    @return True if \e chain is a safe chain in \e hasse
+  /**
+    @brief Stack frame of the enumeration: a branching point on the current
+           path
   */
-  bool safe_chain(const HDVertex v, const HDGraph& hasse);
+  struct Frame {
+    /// Residual graphs, the first one branches
+    std::list<Pending> pending{};
+    /// Characters of the safe sources left to try
+    std::list<std::list<SignedCharacter>> sources{};
+    /// Length of the current reduction before the branching point
+    size_t prefix = 0;
+  };
 
   /**
-    @brief Test if \e source_v satisfies the test 1 in \e hasse
+    @brief Reduce \e pending until it branches, fails or is empty
 
-    Test 1:
-    A source s is safe for GRB if there exists a species s' in GRB|CM∪A that
-    consists of C(s), is connected to only inactive characters and the
-    realization of C(s') in GRB does not induce red Σ-graphs in GRB.
+    The non-branching realizations are appended to the current reduction; a
+    branching point is pushed on the stack.
 
-    @param[in] hasse Hasse diagram graph
+    @param[in,out] pending Residual graphs
 
-    @return True if \e source_v satisfies the test 1
+    @return True if \e pending was reduced to nothing (the current reduction
+            is complete)
   */
-  bool safe_source_test1(const HDGraph& hasse);
+  bool descend(std::list<Pending>& pending);
 
- private:
-  std::list<HDVertex>* const m_safe_sources{};
-  std::list<HDVertex>* const m_sources{};
-  std::list<HDEdge> chain{};
-  HDVertex source_v{};
-  HDVertex last_v{};
+  std::list<Pending> m_start{};              ///< Input graph, until started
+  std::vector<Frame> m_path{};               ///< Branching points
+  std::list<SignedCharacter> m_reduction{};  ///< Current reduction
+  bool m_started = false;
 };
 
+//=============================================================================
+// Typedefs used for readabily
+
+/**
+  Realized characters (list of signed characters), paired with a flag that is
+  True if the c-reduction was successful.
+  When the flag is false, the list is empty
+*/
+typedef std::pair<std::list<SignedCharacter>, bool> ReductionResult;
+
+/**
+  Number of complete successful reductions, paired with the number of partial
+  ones (see \e is_partial).
+  The counts stop at the largest size_t: a count equal to it is a lower bound
+*/
+typedef std::pair<size_t, size_t> ReductionCount;
+
+/**
+  Number of successful reductions of the graphs reduced so far, keyed by
+  fingerprint
+*/
+typedef std::unordered_map<std::string, ReductionCount> ReductionCountMap;
+
+//=============================================================================
+// Enum / Struct operator overloads
+
+/**
+  @brief Overloading of operator<< for Strategy
+
+  @param[in] os       Output stream
+  @param[in] strategy Strategy
+
+  @return Updated output stream
+*/
+std::ostream& operator<<(std::ostream& os, const Strategy& strategy);
+
 //=============================================================================
 // Algorithm functions
 
@@ -192,11 +360,44 @@ class initial_state_visitor : public boost::default_dfs_visitor {
   The source s of a safe chain C is the initial state of a tree T solving GRB
   if s is safe.
 
-  @param[in] hasse Hasse diagram graph
+  The cover relations of a lazy Hasse diagram are built only for the vertices
+  reached by the search.
+
+  @param[in,out] hasse Hasse diagram graph
 
   @return List of safe sources
 */
-std::list<HDVertex> initial_states(const HDGraph& hasse);
+std::list<HDVertex> initial_states(HDGraph& hasse);
+
+/**
+  @brief Check if \e chain is a safe chain in \e hasse
+
+  Let GRB be a red-black graph, let P be the Hasse diagram for GRB|CM and let
+  C be a chain of P.
+  Then C is safe if the c-reduction S(C) of C is feasible for the graph and
+  applying S(C) to GRB results in a graph that has no red Σ-graphs.
+
+  @param[in] chain Maximal chain of \e hasse
+  @param[in] hasse Hasse diagram graph
+
+  @return True if \e chain is a safe chain in \e hasse
+*/
+bool safe_chain(const HDChain& chain, const HDGraph& hasse);
+
+/**
+  @brief Test if \e source satisfies the test 1 in \e hasse
+
+  Test 1:
+  A source s is safe for GRB if there exists a species s' in GRB|CM∪A that
+  consists of C(s), is connected to only inactive characters and the
+  realization of C(s') in GRB does not induce red Σ-graphs in GRB.
+
+  @param[in] source Source vertex
+  @param[in] hasse  Hasse diagram graph
+
+  @return True if \e source satisfies the test 1
+*/
+bool safe_source_test1(const HDVertex source, const HDGraph& hasse);
 
 /**
   @brief Test if \e sources contain a source that satisfies the test 2 in
@@ -244,6 +445,24 @@ std::list<HDVertex> safe_source_test3(const std::list<HDVertex>& sources,
 */
 bool realize_source(const HDVertex source, const HDGraph& hasse);
 
+/**
+  @brief Sort \e sources by the safe source ordering policy
+
+  The sort is stable: safe sources with the same priority keep the order in
+  which they were found.
+
+  @param[in,out] sources List of safe sources of \e hasse
+  @param[in]     hasse   Hasse diagram graph
+*/
+void order_sources(std::list<HDVertex>& sources, const HDGraph& hasse);
+
+/**
+  @brief Return the statistics of the safe source ordering
+
+  @return Statistics of the safe source ordering
+*/
+OrderingStats& ordering_stats();
+
 /**
   @brief Check if \e reduction is not a complete c-reduction
 
@@ -253,6 +472,181 @@ bool realize_source(const HDVertex source, const HDGraph& hasse);
 */
 bool is_partial(const std::list<SignedCharacter>& reduction);
 
+/**
+  @brief Update the maximal characters \e cm after the realization of \e lsc
+         in \e g
+
+  Only the characters affected by the realization are reclassified.
+
+  @param[in,out] cm  Maximal characters of \e g
+  @param[in]     lsc List of realized signed characters
+  @param[in]     g   Red-black graph
+
+  @return Names of the characters that became maximal
+*/
+std::list<std::string> update_maximal_characters(
+    MaximalCharacters& cm, const std::list<SignedCharacter>& lsc,
+    const RBGraph& g);
+
+/**
+  @brief Reduce a copy of \e g after the realization of the safe source
+         \e source of \e hasse
+
+  Used by the exponential algorithm to test a single safe source: \e g and
+  \e cm are only read, so the safe sources of \e hasse can be tested
+  concurrently.
+
+  @param[in] source Safe source of \e hasse
+  @param[in] hasse  Hasse diagram graph
+  @param[in] g      Red-black graph
+  @param[in] cm     Maximal characters of \e g
+
+  @return Realized characters (list of signed characters), that is the
+          realization of \e source followed by a c-reduction of the rest of
+          \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+ReductionResult reduce_source(const HDVertex source, const HDGraph& hasse,
+                              const RBGraph& g, const MaximalCharacters& cm);
+
+/**
+  @brief Reduce \e g after the realization of the safe source \e source of
+         \e hasse
+
+  Used by the exponential algorithm, within its memory budget, to test the
+  last safe source without copying \e g.
+
+  @param[in]     source Safe source of \e hasse
+  @param[in]     hasse  Hasse diagram graph
+  @param[in,out] g      Red-black graph
+  @param[in,out] cm     Maximal characters of \e g
+
+  @return Realized characters (list of signed characters), that is the
+          realization of \e source followed by a c-reduction of the rest of
+          \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+ReductionResult reduce_source_in_place(const HDVertex source,
+                                       const HDGraph& hasse, RBGraph& g,
+                                       MaximalCharacters& cm);
+
+/**
+  @brief Return the thread pool of the parallel exponential algorithm
+
+  The pool is started on first use with \e parallel::threads workers.
+
+  @return Thread pool
+*/
+ThreadPool& branch_pool();
+
+/**
+  @brief Return the transposition table of the exponential algorithm
+
+  Every thread has its own table, which holds the graphs of the instance it is
+  reducing: it must be cleared before the thread moves to another instance.
+  The branches tested in parallel by --threads use the table of the search
+  they belong to (see \e branch_table).
+
+  @return Transposition table of the calling thread
+*/
+TranspositionTable& transposition_table();
+
+/**
+  @brief Return the transposition table of the search the calling thread is
+         testing a branch of
+
+  @return Reference to the table of the calling thread (nullptr if it uses its
+          own)
+*/
+TranspositionTable*& branch_table();
+
+/**
+  @brief Return the choices of the exponential algorithm in progress, from
+         the root of the search
+
+  @return Reference to the choices in progress
+*/
+std::list<CheckpointFrame>& checkpoint_frames();
+
+/**
+  @brief Return the choices of the exponential algorithm to resume, from the
+         root of the search
+
+  When the algorithm reaches a choice on the same graph as the first one of
+  the list, it skips the safe sources that were already tested and removes
+  the choice from the list.
+
+  @return Reference to the choices to resume
+*/
+std::list<CheckpointFrame>& resume_frames();
+
+/**
+  @brief Write the state of the exponential algorithm to \e filename
+
+  The state is made of the choices in progress (see \e checkpoint_frames)
+  and of the transposition table: the graphs of the choices aren't stored,
+  since the algorithm reaches them again from the input graph.
+
+  @param[in] filename Filename
+*/
+void save_checkpoint(const std::string& filename);
+
+/**
+  @brief Read the state of the exponential algorithm from \e filename
+
+  The choices are appended to \e resume_frames and the graphs are added to
+  the transposition table.
+
+  @param[in] filename Filename
+*/
+void load_checkpoint(const std::string& filename);
+
+/**
+  @brief Return the memory budget of the search
+
+  @return Reference to the memory budget
+*/
+MemoryBudget& memory_budget();
+
+/**
+  @brief Return the cancellation token of the branch of the exponential
+         algorithm running on the calling thread
+
+  With --first-success, the branches that follow a successful branch are
+  cancelled: the reductions running under a cancelled token fail as soon as
+  possible.
+
+  @return Reference to the token of the calling thread (nullptr if none)
+*/
+const CancellationToken*& branch_cancellation();
+
+/**
+  @brief Check if the branch running on the calling thread has been cancelled
+
+  @return True if the branch has been cancelled
+*/
+inline bool branch_cancelled() {
+  return branch_cancellation() != nullptr &&
+         branch_cancellation()->cancelled();
+}
+
+/**
+  @brief Return the branch path followed by the calling thread
+
+  @return Reference to the branch path of the calling thread
+*/
+BranchPath& branch_path();
+
+/**
+  @brief Return the fingerprint hashes of the graphs that can't be reduced,
+         shared by the processes of a sharded search
+
+  @return Reference to the shared set (nullptr if none)
+*/
+SharedHashSet*& shared_failures();
+
 //=============================================================================
 // Algorithm main functions
 
@@ -267,6 +661,9 @@ bool is_partial(const std::list<SignedCharacter>& reduction);
   The extended c-reduction of R is the sequence of positive and negative
   characters obtained by the application of R to GRB.
 
+  Throws NoReduction if \e g can't be reduced; use \e try_reduce to handle the
+  failure without exceptions.
+
   @param[in,out] g Red-black graph
 
   @return Realized characters (list of signed characters), that is a
@@ -274,6 +671,171 @@ bool is_partial(const std::list<SignedCharacter>& reduction);
 */
 std::list<SignedCharacter> reduce(RBGraph& g);
 
+/**
+  @brief Compute an extended c-reduction that is a successful reduction of a
+         reducible graph
+
+  The maximal characters \e cm of \e g are given by the caller (e.g. when they
+  were already computed to build the maximal reducible graph of \e g).
+  Throws NoReduction if \e g can't be reduced.
+
+  @param[in,out] g  Red-black graph
+  @param[in,out] cm Maximal characters of \e g
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g
+*/
+std::list<SignedCharacter> reduce(RBGraph& g, MaximalCharacters& cm);
+
+/**
+  @brief Compute an extended c-reduction that is a successful reduction of a
+         reducible graph, without throwing on failure
+
+  Failures of the recursive calls (and of the branches of the exponential
+  algorithm) are returned to the caller instead of being thrown, so no stack
+  unwinding is involved.
+
+  @param[in,out] g Red-black graph
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+ReductionResult try_reduce(RBGraph& g);
+
+/**
+  @brief Compute an extended c-reduction that is a successful reduction of a
+         reducible graph, without throwing on failure
+
+  The maximal characters \e cm are updated after every realization, instead
+  of being computed again at every level of the recursion.
+
+  @param[in,out] g  Red-black graph
+  @param[in,out] cm Maximal characters of \e g
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+ReductionResult try_reduce(RBGraph& g, MaximalCharacters& cm);
+
+/**
+  @brief Compute an extended c-reduction that is a successful reduction of a
+         reducible graph, without throwing on failure
+
+  The components map of \e g is given by the caller, so it's not computed again
+  on the first level of the recursion.
+
+  @param[in,out] g       Red-black graph
+  @param[in,out] cm      Maximal characters of \e g
+  @param[in]     c_map   Components map of \e g
+  @param[in]     c_count Number of connected components of \e g
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+ReductionResult try_reduce(RBGraph& g, MaximalCharacters& cm,
+                           const RBVertexIMap& c_map, const size_t c_count);
+
+/**
+  @brief Count the successful reductions of \e g computed by the exponential
+         algorithm, without building them
+
+  Every safe source is counted, so \e exponential::enabled must be set.
+
+  @param[in,out] g Red-black graph
+
+  @return Number of complete and of partial successful reductions of \e g
+*/
+ReductionCount count_reductions(RBGraph& g);
+
+/**
+  @brief Count the successful reductions of \e g computed by the exponential
+         algorithm, without building them
+
+  @param[in,out] g  Red-black graph
+  @param[in,out] cm Maximal characters of \e g
+
+  @return Number of complete and of partial successful reductions of \e g
+*/
+ReductionCount count_reductions(RBGraph& g, MaximalCharacters& cm);
+
+/**
+  @brief Count the successful reductions of \e g computed by the exponential
+         algorithm, without building them
+
+  The counts of the residual graphs are stored in \e memo, so each of them is
+  counted once.
+  A reduction is partial if it loses one of the \e unpaired characters, i.e.
+  an active character of the input graph that was never gained.
+
+  @param[in,out] g        Red-black graph
+  @param[in,out] cm       Maximal characters of \e g
+  @param[in]     unpaired Active characters that were never gained
+  @param[in,out] memo     Counts of the residual graphs
+
+  @return Number of complete and of partial successful reductions of \e g
+*/
+ReductionCount count_reductions(RBGraph& g, MaximalCharacters& cm,
+                                std::set<std::string> unpaired,
+                                ReductionCountMap& memo);
+
+/**
+  @brief Compute a successful reduction of \e g with \e processes worker
+         processes
+
+  The branches of the first choice of the exponential algorithm are queued in
+  shared memory: the workers take them one at a time, follow them to the end
+  and publish their outcomes, and the fingerprints of the graphs that can't be
+  reduced.
+  A worker that crashes is replaced, and its branch is queued again (once).
+  The outcomes are merged in the order of the safe sources, as in the
+  exponential algorithm.
+
+  @param[in] g         Red-black graph
+  @param[in] processes Number of worker processes
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+ReductionResult try_reduce_sharded(const RBGraph& g, const size_t processes);
+
+/**
+  @brief Return \e count strategies for the portfolio solver
+
+  The first strategy is the default one (the first safe source), followed by
+  the selection of the 2nd, 3rd, ... safe source alternated with the random
+  selection with seed 1, 2, ...
+
+  @param[in] count Number of strategies
+
+  @return List of strategies
+*/
+std::vector<Strategy> portfolio_strategies(const size_t count);
+
+/**
+  @brief Compute a successful reduction of \e g by racing the \e strategies
+
+  Every strategy reduces its own copy of \e g on its own thread; the first
+  successful one cancels the others.
+
+  @param[in] g          Red-black graph
+  @param[in] strategies Safe source selection strategies
+
+  @return Realized characters (list of signed characters), that is a
+          c-reduction of \e g.
+          If the reduction was successful then the bool flag will be true.
+          When the flag is false, the returned list is empty
+*/
+ReductionResult try_reduce_portfolio(const RBGraph& g,
+                                     const std::vector<Strategy>& strategies);
+
 /**
   @brief Realize the character \e c (+ or -) in \e g
 
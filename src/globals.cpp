@@ -3,19 +3,37 @@
 //=============================================================================
 // Output modifiers
 
-bool logging::enabled = false;
+thread_local bool logging::enabled = false;
 
 //=============================================================================
 // Algorithm modifiers
 
 bool exponential::enabled = false;
 
+bool exponential::first_success = false;
+
 bool interactive::enabled = false;
 
-size_t nthsource::index = 0;
+thread_local size_t nthsource::index = 0;
+
+thread_local bool randomsource::enabled = false;
+
+thread_local std::mt19937 randomsource::engine;
 
 bool active::enabled = false;
 
+bool collapse::enabled = false;
+
 bool reduced_hasse::enabled = false;
 
+ordering::Policy ordering::policy = ordering::Policy::discovery;
+
+bool ordering::stats = false;
+
+size_t parallel::threads = 1;
+
+size_t memory::limit = 0;
+
+std::string checkpoint::file;
 
+size_t checkpoint::interval = 60;
@@ -2,16 +2,21 @@
 #define GLOBALS_HPP
 
 #include <list>
+#include <random>
 #include <string>
 
 //=============================================================================
 // Output modifiers
 
+// The options are set while the command line is parsed, and only read by the
+// algorithm afterwards: the toggles that change during a reduction are thread
+// local, so that several files can be reduced at the same time (--jobs).
+
 /**
   @brief Global logging namespace
 */
 namespace logging {
-extern bool enabled;  ///< Logging toggle
+extern thread_local bool enabled;  ///< Logging toggle (of the current thread)
 };
 
 //=============================================================================
@@ -21,7 +26,8 @@ extern bool enabled;  ///< Logging toggle
   @brief Global exponential algorithm namespace
 */
 namespace exponential {
-extern bool enabled;  ///< Exponential algorithm toggle
+extern bool enabled;        ///< Exponential algorithm toggle
+extern bool first_success;  ///< Stop at the first successful safe source
 };
 
 /**
@@ -35,7 +41,15 @@ extern bool enabled;  ///< User interaction toggle
   @brief Global safe source selection namespace
 */
 namespace nthsource {
-extern size_t index;  ///< Safe source index selection
+extern thread_local size_t index;  ///< Safe source index selection
+};
+
+/**
+  @brief Global random safe source selection namespace
+*/
+namespace randomsource {
+extern thread_local bool enabled;         ///< Random safe source selection
+extern thread_local std::mt19937 engine;  ///< Random number engine
 };
 
 /**
@@ -45,12 +59,60 @@ namespace active {
 extern bool enabled;  ///< Safe source index selection
 };
 
+/**
+  @brief Global duplicate species namespace
+*/
+namespace collapse {
+extern bool enabled;  ///< Collapse the species with the same characters
+};
+
 /**
   @brief Global hasse reduction switch namespace
 */
 namespace reduced_hasse {
 extern bool enabled;
 }
+
+/**
+  @brief Global safe source ordering namespace
+*/
+namespace ordering {
+/**
+  @brief Ordering policies of the safe sources
+*/
+enum class Policy {
+  discovery,   ///< Order in which the safe sources are found
+  characters,  ///< Most characters first
+  active,      ///< Fewest active characters first
+  reduction    ///< Largest reduction of the graph first
+};
+
+extern Policy policy;  ///< Safe source ordering policy
+
+extern bool stats;  ///< Find every safe source, for the statistics
+};
+
+/**
+  @brief Global parallel search namespace
+*/
+namespace parallel {
+extern size_t threads;  ///< Number of threads of the exponential search
+};
+
+/**
+  @brief Global memory budget namespace
+*/
+namespace memory {
+extern size_t limit;  ///< Memory budget of the search, in bytes (0 = none)
+};
+
+/**
+  @brief Global checkpoint namespace
+*/
+namespace checkpoint {
+extern std::string file;  ///< Checkpoint file of the search (empty = none)
+extern size_t interval;   ///< Seconds between two checkpoints
+};
 //=============================================================================
 // Typedefs used for readabily
 
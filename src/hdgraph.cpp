@@ -1,6 +1,120 @@
 #include <algorithm>
 #include "hdgraph.hpp"
 
+//=============================================================================
+// Auxiliary structs and classes
+
+ChainEnumerator::ChainEnumerator(HDGraph& hasse)
+    : ChainEnumerator(hasse, source_vertices(hasse)) {}
+
+ChainEnumerator::ChainEnumerator(HDGraph& hasse,
+                                 const std::list<HDVertex>& sources)
+    : m_hasse{&hasse},
+      m_sources{sources},
+      m_path{},
+      m_visited{},
+      m_skip{false} {}
+
+bool ChainEnumerator::next(HDChain& chain) {
+  while (true) {
+    if (m_path.empty()) {
+      // the chains of the previous source are over, move to the next source
+      m_skip = false;
+
+      if (m_sources.empty()) return false;
+
+      const auto v = m_sources.front();
+      m_sources.pop_front();
+
+      if (m_visited.count(v) == 0) push(v);
+
+      continue;
+    }
+
+    auto& top = m_path.back();
+
+    if (top.e == top.e_end) {
+      // every outgoing edge of the top vertex has been explored
+      const bool sink = (out_degree(top.v, *m_hasse) == 0);
+
+      if (sink && !m_skip) {
+        // a sink reached for the first time ends a chain
+        chain.source = m_path.front().v;
+        chain.sink = top.v;
+        chain.edges.clear();
+
+        for (auto f = m_path.cbegin(); std::next(f) != m_path.cend(); ++f) {
+          chain.edges.push_back(*f->e);
+        }
+      }
+
+      pop();
+
+      if (sink && !m_skip) return true;
+
+      continue;
+    }
+
+    const auto v = target(*top.e, *m_hasse);
+
+    if (m_visited.count(v) == 0) {
+      // descend into a new vertex
+      push(v);
+
+      continue;
+    }
+
+    if (m_skip || out_degree(v, *m_hasse) > 1) {
+      // the chains through v have already been yielded
+      ++top.e;
+
+      continue;
+    }
+
+    // v has already been visited, but it has a single path to a sink: the
+    // path continues along it
+    chain.source = m_path.front().v;
+    chain.edges.clear();
+
+    for (const auto& f : m_path) {
+      chain.edges.push_back(*f.e);
+    }
+
+    auto sink = v;
+    while (out_degree(sink, *m_hasse) == 1) {
+      HDOutEdgeIter oe;
+      std::tie(oe, std::ignore) = out_edges(sink, *m_hasse);
+
+      chain.edges.push_back(*oe);
+      sink = target(*oe, *m_hasse);
+    }
+
+    chain.sink = sink;
+
+    ++top.e;
+
+    return true;
+  }
+}
+
+void ChainEnumerator::skip_source() { m_skip = !m_path.empty(); }
+
+void ChainEnumerator::push(const HDVertex v) {
+  expand_vertex(v, *m_hasse);
+
+  Frame f;
+  f.v = v;
+  std::tie(f.e, f.e_end) = out_edges(v, *m_hasse);
+
+  m_path.push_back(f);
+  m_visited.insert(v);
+}
+
+void ChainEnumerator::pop() {
+  m_path.pop_back();
+
+  if (!m_path.empty()) ++m_path.back().e;
+}
 
 //=============================================================================
 // Boost functions (overloading)
@@ -84,6 +198,38 @@ std::ostream& operator<<(std::ostream& os, const HDGraph& hasse) {
   return os;
 }
 
+std::list<HDVertex> source_vertices(const HDGraph& hasse) {
+  std::list<HDVertex> output;
+
+  HDVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    if (!hasse[boost::graph_bundle].lazy) {
+      if (in_degree(*v, hasse) == 0) output.push_back(*v);
+
+      continue;
+    }
+
+    // vertices are sorted by number of characters, so a vertex included in v
+    // can only come before v
+    bool source = true;
+
+    HDVertexIter u;
+    for (u = vertices(hasse).first; u != v; ++u) {
+      if (hasse[*u].characters.size() < hasse[*v].characters.size() &&
+          is_included(hasse[*u].characters, hasse[*v].characters)) {
+        source = false;
+
+        break;
+      }
+    }
+
+    if (source) output.push_back(*v);
+  }
+
+  return output;
+}
+
 //=============================================================================
 // Algorithm functions
 
@@ -99,8 +245,7 @@ bool is_included(const std::list<std::string>& a,
 }
 
 
-
-void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
+void hasse_vertices(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
   std::vector<std::list<RBVertex>> vec_adj_char(num_species(gm));
   std::map<RBVertex, std::list<RBVertex>> adj_char;
   hasse[boost::graph_bundle].num_v = 0;
@@ -174,7 +319,9 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
   // sort vec_adj_char by size in ascending order
   std::sort(vec_adj_char.begin(), vec_adj_char.end(), compare_size);
 
-  bool first_iteration = true;
+  // hdv_map[C] => vertex of the Hasse diagram whose characters are C
+  std::map<std::list<std::string>, HDVertex> hdv_map;
+
   for (const auto& set : vec_adj_char) {
     // for each set of characters
     if (set.empty()) continue;
@@ -190,73 +337,20 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
 
     lcv.sort(compare_names);
 
-    if (first_iteration) {
-      // first iteration of the loop:
-      // add v to the Hasse diagram, and being the first vertex of the graph
-      // there's no need to do any work
-      add_vertex(gm[v].name, lcv, hasse);
+    const auto hdv = hdv_map.find(lcv);
 
-      first_iteration = false;
+    if (hdv != hdv_map.cend()) {
+      // there is a vertex with the same characters as v:
+      // add v (and the species collapsed into it) to the list of species in
+      // hdv
+      hasse[hdv->second].species.splice(hasse[hdv->second].species.cend(),
+                                         species_names(v, gm));
 
       continue;
     }
 
-    // new_edges will contain the list of edges that may be added to the Hasse
-    // diagram: HDVertex is the source, std::string is the edge label
-    std::list<std::pair<HDVertex, std::string>> new_edges;
-
-    // check if there is a vertex with the same characters as v or if v needs
-    // to be added to the Hasse diagram
-    HDVertexIter hdv, hdv_end;
-    std::tie(hdv, hdv_end) = vertices(hasse);
-    for (; hdv != hdv_end; ++hdv) {
-      // for each vertex in hasse
-
-      if (lcv == hasse[*hdv].characters) {
-        // v and hdv have the same characters
-
-        // add v to the list of species in hdv
-        hasse[*hdv].species.push_back(gm[v].name);
-
-        break;
-      }
-
-      const std::list<std::string> lhdv = hasse[*hdv].characters;
-
-      // initialize new_edges if lhdv is a subset of lcv, with the structure:
-      // *hdv -*ci-> v
-      if (is_included(lhdv, lcv)) {
-        // hdv is included in v
-        for (const auto& ci : lcv) {
-          // for each character in hdv
-          const auto in = std::find(lhdv.cbegin(), lhdv.cend(), ci);
-
-          if (in == lhdv.end()) {
-            // character is not present in lhdv
-            new_edges.push_back(std::make_pair(*hdv, ci));
-          }
-        }
-      }
-
-      // on the last iteration of the cycle, after having collected all the
-      // pairs in new_edges, add vertex and edges to the Hasse diagram
-      if (std::next(hdv) == hdv_end) {
-        // last iteration on the characters in the list has been performed
-
-        // build a vertex for v and add it to the Hasse diagram
-        const auto u = add_vertex(gm[v].name, lcv, hasse);
-
-        // build in_edges for the vertex and add them to the Hasse diagram
-        for (const auto& ei : new_edges) {
-          // for each new edge to add to the Hasse diagram
-          HDEdge edge;
-          std::tie(edge, std::ignore) = add_edge(ei.first, u, hasse);
-          hasse[edge].signedcharacters.push_back({ei.second, State::gain});
-        }
-
-        break;
-      }
-    }
+    // build a vertex for v and add it to the Hasse diagram
+    hdv_map[lcv] = add_vertex(species_names(v, gm), lcv, hasse);
   }
 
   // Store the graph pointer into the Hasse diagram's graph properties
@@ -266,7 +360,8 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
   // properties
   hasse[boost::graph_bundle].gm = &gm;
 
-  transitive_reduction(hasse); 
+  // no cover relation has been built yet
+  hasse[boost::graph_bundle].lazy = true;
 
   // sort species names in each vertex
   HDVertexIter u, u_end;
@@ -279,6 +374,68 @@ void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
     hasse[*u].species.clear();
     hasse[*u].species.splice(hasse[*u].species.cend(), species);
   }
+}
+
+void expand_vertex(const HDVertex v, HDGraph& hasse) {
+  if (hasse[v].expanded) return;
+
+  const auto& lcv = hasse[v].characters;
+
+  // covers holds the vertices u such that C(v) ⊂ C(u) and there is no vertex
+  // w such that C(v) ⊂ C(w) ⊂ C(u). Vertices are sorted by number of
+  // characters in ascending order, so when u is reached every cover of v
+  // smaller than u has already been found
+  std::list<HDVertex> covers;
+
+  HDVertexIter u, u_end;
+  std::tie(u, u_end) = vertices(hasse);
+  for (; u != u_end; ++u) {
+    const auto& lcu = hasse[*u].characters;
+
+    if (lcu.size() <= lcv.size() || !is_included(lcv, lcu))
+      // u doesn't strictly include v
+      continue;
+
+    bool cover = true;
+
+    for (const auto& w : covers) {
+      if (is_included(hasse[w].characters, lcu)) {
+        // v < w < u
+        cover = false;
+
+        break;
+      }
+    }
+
+    if (!cover) continue;
+
+    covers.push_back(*u);
+
+    // build the edge v -> u, labeled by the characters gained in u
+    HDEdge edge;
+    std::tie(edge, std::ignore) = add_edge(v, *u, hasse);
+
+    for (const auto& ci : lcu) {
+      if (std::find(lcv.cbegin(), lcv.cend(), ci) == lcv.cend())
+        hasse[edge].signedcharacters.push_back({ci, State::gain});
+    }
+  }
+
+  hasse[v].expanded = true;
+}
+
+void hasse_diagram(HDGraph& hasse, const RBGraph& g, const RBGraph& gm) {
+  hasse_vertices(hasse, g, gm);
+
+  // build the cover relations of every vertex
+  HDVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    expand_vertex(*v, hasse);
+  }
+
+  hasse[boost::graph_bundle].lazy = false;
+
   if(reduced_hasse::enabled)
     reduce_diagram(hasse, gm);
 }
@@ -300,7 +457,7 @@ void reduce_diagram(HDGraph& hasse, const RBGraph& gm){
     std::tie(rbe, rbe_end) = out_edges(*rbv, gm);
     while(*rbe != *rbe_end) {
       if(is_red(*rbe, gm)){
-        ls.push_back(gm[*rbv].name);
+        ls.splice(ls.end(), species_names(*rbv, gm));
         break;
       }
       rbe++;
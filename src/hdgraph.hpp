@@ -2,6 +2,7 @@
 #define HDGRAPH_HPP
 
 #include <boost/graph/graph_utility.hpp>
+#include <set>
 #include "globals.hpp"
 #include "rbgraph.hpp"
 
@@ -59,6 +60,8 @@ struct HDEdgeProperties {
 struct HDVertexProperties {
   std::list<std::string> species{};  ///< List of species that label the vertex
   std::list<std::string> characters{};  ///< List of characters of the species
+  bool expanded = false;  ///< True if the outgoing edges (cover relations) of
+                          ///< the vertex have been built
 };
 
 /**
@@ -68,6 +71,7 @@ struct HDGraphProperties {
   const RBGraph* g{};   ///< Original red-black graph
   const RBGraph* gm{};  ///< Original maximal reducible graph
   size_t num_v; ///< Number of vertices
+  bool lazy = false;    ///< True if the cover relations are built on demand
 };
 
 //=============================================================================
@@ -143,6 +147,105 @@ typedef boost::associative_property_map<HDVertexIMap> HDVertexIAssocMap;
 typedef std::map<HDVertex, size_t> HDVertexIndexMap;
 typedef boost::associative_property_map<HDVertexIndexMap> HDVertexIndexAssocMap;
 
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Struct used to represent a maximal chain of a Hasse diagram
+
+  A maximal chain is a path in the Hasse diagram that starts from a source
+  (a vertex with no incoming edges) and ends in a sink (a vertex with no
+  outgoing edges).
+  A source that is also a sink is a maximal chain with no edges.
+*/
+struct HDChain {
+  HDVertex source{};          ///< First vertex of the chain
+  HDVertex sink{};            ///< Last vertex of the chain
+  std::list<HDEdge> edges{};  ///< Edges of the chain, from source to sink
+};
+
+/**
+  @brief Resumable enumerator of the maximal chains of a Hasse diagram
+
+  Chains are yielded one at a time by \e next, grouped by source and in
+  depth-first order, each chain at most once.
+  Like a depth-first visit, every vertex is descended into only once: a chain
+  ends at a sink reached for the first time, or continues through an edge to
+  a vertex already visited only if that vertex has a single path to a sink.
+  So at most one chain is yielded for each edge of the diagram, instead of
+  the maximal chains, which can be exponentially many.
+  The cover relations of a lazy diagram are expanded as the enumeration
+  descends into its vertices.
+  The enumeration only holds the path it is currently on and the visited
+  vertices, so it can be stopped and resumed at any point.
+  Consumers working in parallel can partition the sources of the diagram and
+  build one enumerator for each partition.
+*/
+class ChainEnumerator {
+ public:
+  /**
+    @brief Enumerator constructor, for every source of \e hasse
+
+    @param[in] hasse Hasse diagram graph
+  */
+  ChainEnumerator(HDGraph& hasse);
+
+  /**
+    @brief Enumerator constructor, for the given \e sources of \e hasse
+
+    @param[in] hasse   Hasse diagram graph
+    @param[in] sources List of source vertices to enumerate the chains of
+  */
+  ChainEnumerator(HDGraph& hasse, const std::list<HDVertex>& sources);
+
+  /**
+    @brief Move to the next maximal chain
+
+    @param[out] chain Next maximal chain, left untouched if there is none
+
+    @return True if a chain was found, False if the enumeration is over
+  */
+  bool next(HDChain& chain);
+
+  /**
+    @brief Skip the remaining chains of the current source
+
+    The next call to \e next yields the first chain of the following source.
+    The rest of the current source is still visited, so the chains of the
+    following sources don't depend on the skipped ones.
+  */
+  void skip_source();
+
+ private:
+  /**
+    @brief Stack frame of the enumeration: a vertex on the current path and
+           the outgoing edge the path continues with
+  */
+  struct Frame {
+    HDVertex v{};                ///< Vertex
+    HDOutEdgeIter e{}, e_end{};  ///< Current and last outgoing edges of v
+  };
+
+  /**
+    @brief Push \e v on top of the current path
+
+    @param[in] v Vertex
+  */
+  void push(const HDVertex v);
+
+  /**
+    @brief Pop the top of the current path and move its parent to the next
+           outgoing edge
+  */
+  void pop();
+
+  HDGraph* const m_hasse{};
+  std::list<HDVertex> m_sources{};
+  std::vector<Frame> m_path{};
+  std::set<HDVertex> m_visited{};
+  bool m_skip = false;
+};
+
 //=============================================================================
 // Enum / Struct operator overloads
 
@@ -268,6 +371,18 @@ inline const RBGraph* const orig_gm(const HDGraph& hasse) {
 */
 std::ostream& operator<<(std::ostream& os, const HDGraph& hasse);
 
+/**
+  @brief Return the sources of \e hasse, in vertex order
+
+  The sources of a lazy diagram are found by comparing the characters of its
+  vertices, without building any cover relation.
+
+  @param[in] hasse Hasse diagram graph
+
+  @return List of vertices with no incoming edges
+*/
+std::list<HDVertex> source_vertices(const HDGraph& hasse);
+
 //=============================================================================
 // Algorithm functions
 
@@ -282,6 +397,31 @@ std::ostream& operator<<(std::ostream& os, const HDGraph& hasse);
 bool is_included(const std::list<std::string>& a,
                  const std::list<std::string>& b);
 
+/**
+  @brief Build the vertices of the Hasse diagram of \e gm
+
+  The resulting diagram is lazy: it has no edges, which are built on demand by
+  \e expand_vertex.
+  Vertices are sorted by number of characters in ascending order.
+
+  @param[out] hasse Hasse diagram graph
+  @param[in]  g     Red-black graph
+  @param[in]  gm    Maximal reducible red-black graph
+*/
+void hasse_vertices(HDGraph& hasse, const RBGraph& g, const RBGraph& gm);
+
+/**
+  @brief Build the outgoing edges of \e v in \e hasse
+
+  Add the arc (v, u) for each vertex u that covers v, that is C(v) ⊂ C(u) and
+  there does not exist a vertex w such that C(v) ⊂ C(w) ⊂ C(u).
+  Does nothing if the edges of \e v have already been built.
+
+  @param[in]     v     Vertex
+  @param[in,out] hasse Hasse diagram graph
+*/
+void expand_vertex(const HDVertex v, HDGraph& hasse);
+
 /**
   @brief Build the Hasse diagram of \e gm
 
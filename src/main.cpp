@@ -1,6 +1,10 @@
 #include <boost/program_options.hpp>
 #include <boost/python.hpp>
+#include <fstream>
+#include <limits>
+#include <map>
 #include "functions.hpp"
+#include "matrix.hpp"
 
 void conflicting_options(const boost::program_options::variables_map& vm,
                          const std::string& opt1, const std::string& opt2) {
@@ -11,10 +15,598 @@ void conflicting_options(const boost::program_options::variables_map& vm,
   }
 }
 
+/**
+  @brief Print the progress line of the file \e file, the \e index th of
+         \e count files
+
+  @param[in] os      Output stream
+  @param[in] file    Filename
+  @param[in] index   Index of the file
+  @param[in] count   Number of files (0 if not known in advance)
+  @param[in] verbose True if the verbose output is enabled
+*/
+void progress(std::ostream& os, const std::string& file, const size_t index,
+              const size_t count, const bool verbose) {
+  if (verbose) {
+    // verbosity enabled
+    os << "F  (" << file << ")" << std::endl;
+  } else {
+    // verbosity disabled
+    if (count > 1) {
+      const auto d_perc = std::floor(100.0 * index / count);
+      const auto perc = static_cast<size_t>(d_perc);
+
+      if (perc < 10) os << " ";
+
+      os << "\033[32m" << perc << "\033[39m (" << file << ")" << std::flush;
+    } else {
+      os << "F  (" << file << ")" << std::flush;
+    }
+  }
+}
+
+/**
+  @brief Print the negative outcome of the file \e file on \e os
+
+  @param[in] os      Output stream
+  @param[in] file    Filename
+  @param[in] reason  Reason of the failure, printed if verbose
+  @param[in] verbose True if the verbose output is enabled
+*/
+void reject(std::ostream& os, const std::string& file,
+            const std::string& reason, const bool verbose) {
+  if (!verbose) {
+    // verbosity disabled
+    os << '\r';
+  }
+
+  os << "No (" << file << ")";
+
+  if (verbose) {
+    // verbosity enabled
+    os << ": " << reason;
+  }
+
+  os << std::endl;
+}
+
+/**
+  @brief Reduce the matrix \e g, read from \e file, printing the outcome on
+         \e os
+
+  @param[in]     os      Output stream
+  @param[in]     file    Filename
+  @param[in,out] g       Red-black graph of the matrix
+  @param[in]     vm      Options given in input
+  @param[in]     pymod   Module check_reduction.py, if --testpy is enabled
+  @param[in]     verbose True if the verbose output is enabled
+*/
+void solve(std::ostream& os, const std::string& file, RBGraph& g,
+           const boost::program_options::variables_map& vm,
+           const boost::python::object& pymod, const bool verbose) {
+  try {
+    std::stringstream keep_c{};
+
+    // maximal characters of g, shared with reduce
+    MaximalCharacters cm(g);
+
+    RBGraph gm = (vm["maximal"].as<bool>()
+                      ? maximal_reducible_graph(g, cm.characters(g))
+                      : RBGraph());
+
+    if (vm["maximal"].as<bool>()) {
+      cm.prune(gm);
+
+      if (vm["testpy"].as<bool>()) {
+        RBVertexIter v, v_end;
+        std::tie(v, v_end) = vertices(gm);
+        for (; v != v_end; ++v) {
+          if (!is_character(*v, gm)) continue;
+
+          keep_c << gm[*v].name.substr(1) << " ";
+        }
+      }
+    }
+
+    if (vm["stream"].as<bool>()) {
+      ReductionEnumerator reductions(vm["maximal"].as<bool>() ? gm : g);
+
+      std::list<SignedCharacter> reduction;
+      size_t count = 0;
+
+      while (reductions.next(reduction)) {
+        if (!verbose && count == 0) {
+          // verbosity disabled
+          os << '\r';
+        }
+
+        os << (is_partial(reduction) ? "Partial" : "Complete") << " (" << file
+         << "): < ";
+
+        for (const auto& sc : reduction) {
+          os << sc << " ";
+        }
+
+        os << ">" << std::endl;
+
+        count++;
+      }
+
+      if (count == 0)
+        // no successful reduction
+        throw NoReduction();
+
+      os << "Ok (" << file << "): " << count << " successful reductions"
+         << std::endl;
+
+      return;
+    }
+
+    if (vm["count"].as<bool>()) {
+      const auto count =
+          count_reductions(vm["maximal"].as<bool>() ? gm : g, cm);
+
+      if (count.first + count.second == 0)
+        // no successful reduction
+        throw NoReduction();
+
+      if (!verbose) {
+        // verbosity disabled
+        os << '\r';
+      }
+
+      // the counts stop at the largest size_t
+      const auto bound = [](const size_t count) {
+        return (count == std::numeric_limits<size_t>::max() ? "at least " : "");
+      };
+
+      os << "Ok (" << file << "): " << bound(count.first) << count.first
+         << " complete, " << bound(count.second) << count.second << " partial"
+         << std::endl;
+
+      return;
+    }
+
+    std::list<SignedCharacter> output;
+
+    if (vm.count("portfolio")) {
+      bool success;
+      std::tie(output, success) = try_reduce_portfolio(
+          vm["maximal"].as<bool>() ? gm : g,
+          portfolio_strategies(vm["portfolio"].as<size_t>()));
+
+      if (!success)
+        // no strategy could reduce the graph
+        throw NoReduction();
+    } else if (vm.count("shards")) {
+      bool success;
+      std::tie(output, success) = try_reduce_sharded(
+          vm["maximal"].as<bool>() ? gm : g, vm["shards"].as<size_t>());
+
+      if (!success)
+        // no branch could reduce the graph
+        throw NoReduction();
+    } else {
+      output = reduce(vm["maximal"].as<bool>() ? gm : g, cm);
+    }
+
+    std::stringstream reduction;
+    for (const auto& sc : output) {
+      reduction << sc << " ";
+    }
+
+    if (vm["testpy"].as<bool>()) {
+      if (vm["maximal"].as<bool>()) {
+        // run the function check_reduction(filename, reduction), store its
+        // output in pycheck
+        const auto pycheck = pymod.attr("check_reduction")(
+            file, reduction.str(), keep_c.str());
+
+        if (!boost::python::extract<bool>(pycheck)())
+          // check_reduction(filename, reduction) returned False
+          throw NoReduction();
+      } else {
+        // run the function check_reduction(filename, reduction), store its
+        // output in pycheck
+        const auto pycheck =
+            pymod.attr("check_reduction")(file, reduction.str());
+
+        if (!boost::python::extract<bool>(pycheck)())
+          // check_reduction(filename, reduction) returned False
+          throw NoReduction();
+      }
+    }
+
+    if (!verbose) {
+      // verbosity disabled
+      os << '\r';
+    }
+
+    os << "Ok (" << file << ")";
+
+    if (verbose) {
+      // verbosity enabled
+      if (exponential::enabled) {
+        // exponential algorithm enabled
+        os << ": Successful reductions have been logged";
+      } else {
+        os << ": < " << reduction.str() << ">";
+      }
+    }
+
+    os << std::endl;
+  } catch (const boost::python::error_already_set& e) {
+    reject(os, file, "Python error", verbose);
+  } catch (const CheckpointMismatch& e) {
+    // not an outcome of the matrix: the whole run is stopped
+    throw;
+  } catch (const std::exception& e) {
+    reject(os, file, e.what(), verbose);
+  }
+
+  // the graphs of this instance say nothing about the next one, and their
+  // fingerprints could match graphs of another matrix: the table is cleared
+  // after the instance (not before, so a resumed search keeps its checkpoint)
+  transposition_table().clear();
+}
+
+/**
+  @brief Struct used to represent an input matrix: a file, or a matrix of a
+         container
+*/
+struct Instance {
+  std::string name{};                            ///< Name (or filename)
+  std::shared_ptr<const Container> container{};  ///< Container, if any
+  size_t index{};                                ///< Index in the container
+  std::string error{};  ///< Error opening the file, if any
+  std::shared_ptr<const MappedFile> file{};  ///< Mapped file, if not in a
+                                             ///< container
+  size_t order{};  ///< Index of the file, for the progress
+};
+
+/**
+  @brief Source of the instances to reduce: the instances of the files given
+         as arguments, then the ones of the files listed in a manifest
+
+  The files are opened one at a time, as the instances are needed, and only
+  once: the format is detected from the mapped file, which is kept in the
+  instance (or in the container) until it is read.
+  The manifest is read one line at a time, so the memory used by the source
+  does not depend on the length of the manifest.
+*/
+class InstanceSource {
+ public:
+  /**
+    @brief Constructor
+
+    @param[in] files    Files given as arguments
+    @param[in] manifest Manifest, one filename per line (nullptr if none)
+    @param[in] first    Index of the first matrix of every container
+    @param[in] last     Index after the last matrix of every container
+  */
+  InstanceSource(std::vector<std::string> files, std::istream* manifest,
+                 const size_t first, const size_t last)
+      : m_files(std::move(files)),
+        m_opened(0),
+        m_manifest(manifest),
+        m_first(first),
+        m_last(last),
+        m_container{},
+        m_file{},
+        m_index(0) {}
+
+  /**
+    @brief Get the next instance
+
+    The files that cannot be opened, and the containers that cannot be read,
+    are returned as instances with an error.
+
+    @param[out] instance Instance
+
+    @return False if there are no more instances
+  */
+  bool next(Instance& instance) {
+    while (true) {
+      if (m_container && m_index < std::min(m_last, m_container->size())) {
+        // the next matrix of the container
+        const size_t index = m_index++;
+
+        try {
+          instance = {m_file + ":" + m_container->name(index), m_container,
+                      index, "", nullptr, m_opened - 1};
+        } catch (const std::exception& e) {
+          instance = {m_file + ":" + std::to_string(index), nullptr, 0,
+                      e.what(), nullptr, m_opened - 1};
+        }
+
+        return true;
+      }
+
+      m_container.reset();
+
+      std::string file;
+      if (m_opened < m_files.size()) {
+        file = m_files[m_opened];
+      } else if (m_manifest == nullptr || !std::getline(*m_manifest, file)) {
+        // no more files
+        return false;
+      }
+
+      // the lines can end with "\r\n", and the empty ones are skipped
+      if (!file.empty() && file.back() == '\r') file.pop_back();
+
+      if (file.empty()) continue;
+
+      m_opened++;
+
+      const auto mapped = std::make_shared<const MappedFile>(file);
+
+      if (!*mapped) {
+        // input file doesn't exist
+        instance = {file, nullptr, 0,
+                    "Failed to read graph from file: no such file or directory",
+                    nullptr, m_opened - 1};
+
+        return true;
+      }
+
+      if (!is_container(mapped->data(), mapped->size())) {
+        instance = {file, nullptr, 0, "", mapped, m_opened - 1};
+
+        return true;
+      }
+
+      try {
+        m_container = std::make_shared<const Container>(mapped);
+      } catch (const std::exception& e) {
+        instance = {file, nullptr, 0, e.what(), nullptr, m_opened - 1};
+
+        return true;
+      }
+
+      m_file = file;
+      m_index = m_first;
+    }
+  }
+
+  /**
+    @brief Return the number of files
+
+    @return Number of files, or 0 if it is not known in advance (there is a
+            manifest)
+  */
+  size_t size() const { return (m_manifest ? 0 : m_files.size()); }
+
+  /**
+    @brief Return the number of files opened so far
+
+    @return Number of files
+  */
+  size_t opened() const { return m_opened; }
+
+ private:
+  std::vector<std::string> m_files;              ///< Files given as
+                                                 ///< arguments
+  size_t m_opened;                               ///< Files opened so far
+  std::istream* m_manifest;                      ///< Manifest, if any
+  size_t m_first;                                ///< First matrix
+  size_t m_last;                                 ///< Last matrix (excluded)
+  std::shared_ptr<const Container> m_container;  ///< Container being read
+  std::string m_file;                            ///< Filename of m_container
+  size_t m_index;                                ///< Next matrix of
+                                                 ///< m_container
+};
+
+/**
+  @brief Read \e instance into \e g
+
+  @param[in]  instance Instance
+  @param[out] g        Red-black graph
+
+  @throw std::runtime_error if the instance cannot be read
+*/
+void read_instance(const Instance& instance, RBGraph& g) {
+  if (!instance.error.empty()) {
+    // the container of the instance cannot be opened
+    throw std::runtime_error(instance.error);
+  }
+
+  if (!instance.container) {
+    load_graph(instance.file->data(), instance.file->size(), g);
+
+    return;
+  }
+
+  Matrix m;
+  SparseMatrix sparse;
+
+  if (instance.container->read(instance.index, m, sparse)) {
+    // the graph is built from the edges, without expanding the matrix
+    if (collapse::enabled) collapse_rows(sparse);
+
+    build_graph(sparse, g);
+  } else {
+    if (collapse::enabled) collapse_rows(m);
+
+    build_graph(m, g);
+  }
+}
+
+/**
+  @brief Read \e instance and reduce it, printing the outcome on \e os
+
+  @param[in] os       Output stream
+  @param[in] instance Instance
+  @param[in] vm       Options given in input
+  @param[in] pymod    Module check_reduction.py, if --testpy is enabled
+  @param[in] verbose  True if the verbose output is enabled
+*/
+void solve(std::ostream& os, const Instance& instance,
+           const boost::program_options::variables_map& vm,
+           const boost::python::object& pymod, const bool verbose) {
+  RBGraph g{};
+
+  if (vm["testpy"].as<bool>() && instance.container) {
+    // check_reduction.py reads the matrices from their files
+    reject(os, instance.name, "--testpy cannot check the matrices of a "
+           "container", verbose);
+
+    return;
+  }
+
+  try {
+    read_instance(instance, g);
+  } catch (const std::exception& e) {
+    reject(os, instance.name, e.what(), verbose);
+
+    return;
+  }
+
+  solve(os, instance.name, g, vm, pymod, verbose);
+}
+
+/**
+  @brief Struct used to represent an instance read by the reader thread of the
+         pipeline
+*/
+struct Parsed {
+  size_t index;                    ///< Index of the instance
+  size_t order;                    ///< Index of its file
+  std::string name;                ///< Name of the instance
+  std::unique_ptr<RBGraph> graph;  ///< Graph of the matrix, if read
+  std::string error;               ///< Reading error, otherwise
+};
+
+/**
+  @brief Struct used to represent an instance reduced by a solver thread of
+         the pipeline
+*/
+struct Solved {
+  size_t index;         ///< Index of the instance
+  size_t order;         ///< Index of its file
+  std::string name;     ///< Name of the instance
+  std::string outcome;  ///< Outcome, to be printed
+};
+
+/**
+  @brief Reduce the instances of \e inputs with a pipeline of threads,
+         printing their outcomes on \e os in the order of the instances
+
+  A reader thread parses the instances, \e jobs solver threads reduce them
+  and the calling thread prints the outcomes.
+  The stages are connected by bounded queues, and at most a fixed number of
+  instances are read and not printed yet, so the memory used by the pipeline
+  does not depend on the number of instances.
+
+  @param[in]     os     Output stream
+  @param[in,out] inputs Source of the instances, read by the reader thread
+  @param[in]     jobs   Number of solver threads
+  @param[in]     vm     Options given in input
+  @param[in]     pymod  Module check_reduction.py, if --testpy is enabled
+*/
+void pipeline(std::ostream& os, InstanceSource& inputs, const size_t jobs,
+              const boost::program_options::variables_map& vm,
+              const boost::python::object& pymod) {
+  // logging and the safe source index are thread local: the solver threads
+  // get the values of the calling thread
+  const bool verbose = logging::enabled;
+  const size_t index = nthsource::index;
+
+  // instances read and not printed yet: the reader takes a slot before
+  // reading an instance, the writer gives it back after printing it
+  BoundedQueue<size_t> window(4 * jobs);
+  BoundedQueue<Parsed> parsed(2 * jobs);
+  BoundedQueue<Solved> solved(2 * jobs);
+
+  // the last solver thread to finish closes the queue of the outcomes
+  std::atomic<size_t> running(jobs);
+
+  std::thread reader([&]() {
+    Instance instance;
+
+    for (size_t i = 0; inputs.next(instance); ++i) {
+      window.push(i);
+
+      Parsed item{i, instance.order, instance.name, std::make_unique<RBGraph>(),
+                  ""};
+
+      try {
+        read_instance(instance, *item.graph);
+      } catch (const std::exception& e) {
+        item.graph.reset();
+        item.error = e.what();
+      }
+
+      parsed.push(std::move(item));
+    }
+
+    parsed.close();
+  });
+
+  std::vector<std::thread> solvers;
+  for (size_t i = 0; i < jobs; ++i) {
+    solvers.emplace_back([&]() {
+      logging::enabled = false;
+      nthsource::index = index;
+
+      Parsed item;
+      while (parsed.pop(item)) {
+        std::ostringstream outcome;
+
+        if (item.graph) {
+          solve(outcome, item.name, *item.graph, vm, pymod, verbose);
+        } else {
+          reject(outcome, item.name, item.error, verbose);
+        }
+
+        // the graph is released before the outcome waits to be printed
+        item.graph.reset();
+
+        solved.push(
+            {item.index, item.order, std::move(item.name), outcome.str()});
+      }
+
+      if (--running == 0) solved.close();
+    });
+  }
+
+  // reorder buffer: the outcome of an instance is printed as soon as the
+  // outcomes of the instances before it are printed
+  std::map<size_t, Solved> outcomes;
+  Solved item;
+  size_t next = 0;
+
+  while (solved.pop(item)) {
+    outcomes.emplace(item.index, std::move(item));
+
+    for (auto it = outcomes.find(next); it != outcomes.end();
+         it = outcomes.find(next)) {
+      progress(os, it->second.name, it->second.order, inputs.size(), verbose);
+      os << it->second.outcome << std::flush;
+
+      outcomes.erase(it);
+      window.pop(next);
+      next++;
+    }
+  }
+
+  reader.join();
+
+  for (auto& solver : solvers) {
+    solver.join();
+  }
+}
+
 int main(int argc, const char* argv[]) {
   // declare the vector of input files
   std::vector<std::string> files;
 
+  // number of files reduced at the same time
+  size_t jobs = 1;
+
+  // range of the matrices of the containers
+  size_t first = 0, last = std::numeric_limits<size_t>::max();
+
   // initialize options menu
   boost::program_options::options_description general_options(
       "Usage: ppp [OPTION...] FILE..."
@@ -40,6 +632,100 @@ int main(int argc, const char* argv[]) {
        "Exponential version of the algorithm.\n"
        "(Mutually exclusive with --interactive)\n"
        "(Mutually exclusive with --nthsource)\n")
+      // option: first-success, stop the exponential algorithm at the first
+      // successful safe source
+      ("first-success,f",
+       boost::program_options::bool_switch(&exponential::first_success),
+       "Stop --exponential at the first successful safe source, instead of "
+       "testing every safe source.\n")
+      // option: count, count the successful reductions
+      ("count,c", boost::program_options::bool_switch()->default_value(false),
+       "Count the successful reductions found by the exponential algorithm "
+       "(complete and partial), without building them.\n"
+       "(Mutually exclusive with --interactive)\n"
+       "(Mutually exclusive with --nthsource)\n")
+      // option: stream, print every successful reduction as soon as it is found
+      ("stream,s", boost::program_options::bool_switch()->default_value(false),
+       "Print every successful reduction found by the exponential algorithm "
+       "as soon as it is found, one at a time.\n"
+       "(Mutually exclusive with --count)\n"
+       "(Mutually exclusive with --interactive)\n"
+       "(Mutually exclusive with --nthsource)\n")
+      // option: order, ordering policy of the safe sources
+      ("order,o",
+       boost::program_options::value<std::string>()->default_value(
+           "discovery"),
+       "Order in which the safe sources are tried: discovery (as they are "
+       "found), characters (most characters first), active (fewest active "
+       "characters first), reduction (largest reduction of the graph "
+       "first).\n")
+      // option: stats, print the statistics of the safe source ordering
+      ("stats", boost::program_options::bool_switch()->default_value(false),
+       "Display how often the first safe source leads to a successful "
+       "reduction, out of the choices between two or more safe sources. "
+       "Every safe source is searched for, even with the discovery order.\n")
+      // option: portfolio, race several safe source selection strategies
+      ("portfolio,p",
+       boost::program_options::value<size_t>()->implicit_value(4),
+       "Race N safe source selection strategies (default 4) concurrently: "
+       "the default one, the nth safe source and the random safe source "
+       "with different seeds. The first successful one is reported.\n"
+       "(Mutually exclusive with --exponential)\n"
+       "(Mutually exclusive with --interactive)\n"
+       "(Mutually exclusive with --nthsource)\n")
+      // option: shards, number of processes of the exponential algorithm
+      ("shards", boost::program_options::value<size_t>(),
+       "Spread --exponential over N worker processes, sharing the branches "
+       "of the first choice through shared memory (implies --exponential).\n"
+       "(Mutually exclusive with --threads)\n"
+       "(Mutually exclusive with --checkpoint and --resume)\n")
+      // option: jobs, number of files reduced at the same time
+      ("jobs,j", boost::program_options::value<size_t>(&jobs)->default_value(1),
+       "Reduce N files at the same time (0 = one per core); the outcomes are "
+       "printed in the order of the files and the verbose output of the "
+       "algorithm is omitted.\n"
+       "(Mutually exclusive with --interactive and --testpy)\n"
+       "(Mutually exclusive with --shards, --checkpoint and --resume)\n")
+      // option: files-from, manifest of the files to reduce
+      ("files-from", boost::program_options::value<std::string>(),
+       "Reduce also the files listed in FILE, one per line (- for the "
+       "standard input): FILE is read while the files are reduced, so it "
+       "can list any number of files.\n")
+      // option: range, matrices of the containers to reduce
+      ("range", boost::program_options::value<std::string>(),
+       "Reduce only the matrices from A to B (excluded) of every container "
+       "in FILE(s), given as A:B (A or B can be omitted).\n")
+      // option: threads, number of threads of the exponential algorithm
+      ("threads",
+       boost::program_options::value<size_t>(&parallel::threads)
+           ->default_value(1),
+       "Number of threads used by --exponential to test the safe sources in "
+       "parallel (0 = one per core); the verbose output of the parallel "
+       "branches is omitted.\n")
+      // option: mem-limit, memory budget of the exponential algorithm
+      ("mem-limit",
+       boost::program_options::value<std::string>()->default_value("0"),
+       "Memory budget (in bytes, or with a K, M or G suffix; 0 = none) of the "
+       "copies of the graph and of "
+       "the memo tables kept by --exponential and --count: when it is "
+       "exceeded the memo tables are evicted and the safe sources are tested "
+       "without copying the graph where possible.\n")
+      // option: checkpoint, save the state of the exponential algorithm
+      ("checkpoint",
+       boost::program_options::value<std::string>(&checkpoint::file),
+       "Periodically save the state of --exponential to FILE (sequential "
+       "search of a single matrix only).\n"
+       "(Mutually exclusive with --threads and --files-from)\n")
+      // option: checkpoint-interval, seconds between two checkpoints
+      ("checkpoint-interval",
+       boost::program_options::value<size_t>(&checkpoint::interval)
+           ->default_value(60),
+       "Seconds between two checkpoints of --checkpoint.\n")
+      // option: resume, resume the exponential algorithm from a checkpoint
+      ("resume", boost::program_options::value<std::string>(),
+       "Resume --exponential from the state saved in FILE by --checkpoint, "
+       "for the same matrix.\n"
+       "(Mutually exclusive with --threads and --files-from)\n")
       // option: interactive, let the user select which path to take
       ("interactive,i",
        boost::program_options::bool_switch(&interactive::enabled),
@@ -52,6 +738,11 @@ int main(int argc, const char* argv[]) {
       // option: active, include active characters during hasse diagram construction
       ("active,a", boost::program_options::bool_switch(&active::enabled),
        "Hasse diagram with active characters.\n")
+      // option: collapse, read every distinct species once
+      ("collapse,d", boost::program_options::bool_switch(&collapse::enabled),
+       "Collapse the species with the same characters while the matrix is "
+       "read: the graph holds every distinct species once, and the species "
+       "collapsed into it are listed with it in the Hasse diagram.\n")
       // option: help message
       ("hasse_reduction,r", boost::program_options::bool_switch(&reduced_hasse::enabled),
         "Exclude active species from Hasse diagram.\n")
@@ -94,10 +785,140 @@ int main(int argc, const char* argv[]) {
 
     conflicting_options(vm, "exponential", "interactive");
 
+    conflicting_options(vm, "count", "interactive");
+    conflicting_options(vm, "count", "nthsource");
+
+    conflicting_options(vm, "portfolio", "exponential");
+    conflicting_options(vm, "portfolio", "interactive");
+    conflicting_options(vm, "portfolio", "nthsource");
+    conflicting_options(vm, "portfolio", "count");
+    conflicting_options(vm, "portfolio", "stream");
+
+    conflicting_options(vm, "stream", "count");
+    conflicting_options(vm, "stream", "interactive");
+    conflicting_options(vm, "stream", "nthsource");
+
+    conflicting_options(vm, "jobs", "interactive");
+    conflicting_options(vm, "jobs", "testpy");
+    conflicting_options(vm, "jobs", "shards");
+    conflicting_options(vm, "jobs", "checkpoint");
+    conflicting_options(vm, "jobs", "resume");
+
+    conflicting_options(vm, "shards", "threads");
+    conflicting_options(vm, "shards", "checkpoint");
+    conflicting_options(vm, "shards", "resume");
+    conflicting_options(vm, "shards", "portfolio");
+    conflicting_options(vm, "shards", "count");
+    conflicting_options(vm, "shards", "stream");
+    conflicting_options(vm, "shards", "interactive");
+    conflicting_options(vm, "shards", "nthsource");
+
+    conflicting_options(vm, "checkpoint", "threads");
+    conflicting_options(vm, "checkpoint", "files-from");
+    conflicting_options(vm, "resume", "threads");
+    conflicting_options(vm, "resume", "files-from");
+
     conflicting_options(vm, "nthsource", "exponential");
     conflicting_options(vm, "nthsource", "interactive");
 
     boost::program_options::notify(vm);
+
+    const auto& order = vm["order"].as<std::string>();
+
+    if (order == "discovery") {
+      ordering::policy = ordering::Policy::discovery;
+    } else if (order == "characters") {
+      ordering::policy = ordering::Policy::characters;
+    } else if (order == "active") {
+      ordering::policy = ordering::Policy::active;
+    } else if (order == "reduction") {
+      ordering::policy = ordering::Policy::reduction;
+    } else {
+      throw std::logic_error(std::string("invalid ordering policy '") + order +
+                             "'");
+    }
+
+    ordering::stats = vm["stats"].as<bool>();
+
+    if (vm.count("files-from") && vm["files-from"].as<std::string>() == "-" &&
+        interactive::enabled) {
+      throw std::logic_error(
+          "--files-from - and --interactive both read the standard input");
+    }
+
+    if ((vm.count("checkpoint") || vm.count("resume")) &&
+        !exponential::enabled) {
+      throw std::logic_error("--checkpoint and --resume need --exponential");
+    }
+
+    if ((vm.count("checkpoint") || vm.count("resume")) && files.size() > 1) {
+      // the state of the search is saved for a single graph
+      throw std::logic_error(
+          "--checkpoint and --resume need a single input file");
+    }
+
+    if (vm.count("range")) {
+      const auto& range = vm["range"].as<std::string>();
+      const auto colon = range.find(':');
+
+      // parse a bound of the range: an omitted bound keeps its default
+      const auto bound = [](const std::string& text, size_t& value) {
+        if (text.empty()) return true;
+
+        size_t digits = 0;
+        if (std::isdigit(static_cast<unsigned char>(text.front())))
+          value = std::stoull(text, &digits);
+
+        return digits == text.size();
+      };
+
+      if (colon == std::string::npos ||
+          !bound(range.substr(0, colon), first) ||
+          !bound(range.substr(colon + 1), last)) {
+        throw std::logic_error(std::string("invalid range '") + range + "'");
+      }
+    }
+
+    const auto& limit = vm["mem-limit"].as<std::string>();
+
+    size_t digits = 0;
+    unsigned long long value = 0;
+    if (!limit.empty() &&
+        std::isdigit(static_cast<unsigned char>(limit.front()))) {
+      try {
+        value = std::stoull(limit, &digits);
+      } catch (const std::out_of_range&) {
+        throw std::logic_error(std::string("memory limit '") + limit +
+                               "' is too large");
+      }
+    }
+
+    const std::string suffix = limit.substr(digits);
+
+    size_t shift = 0;
+    if (suffix == "K") {
+      shift = 10;
+    } else if (suffix == "M") {
+      shift = 20;
+    } else if (suffix == "G") {
+      shift = 30;
+    } else if (!suffix.empty()) {
+      digits = 0;
+    }
+
+    if (digits == 0) {
+      // no digits, or an unknown suffix
+      throw std::logic_error(std::string("invalid memory limit '") + limit +
+                             "'");
+    }
+
+    if (value > (std::numeric_limits<size_t>::max() >> shift)) {
+      // the limit in bytes doesn't fit in size_t
+      throw std::logic_error(std::string("memory limit '") + limit +
+                             "' is too large");
+    }
+
+    memory::limit = static_cast<size_t>(value) << shift;
   } catch (const std::exception& e) {
     // error while parsing the options given in input
     std::cerr << "Error: " << e.what() << "." << std::endl
@@ -107,6 +928,32 @@ int main(int argc, const char* argv[]) {
     return 1;
   }
 
+  if (vm["count"].as<bool>() || vm["stream"].as<bool>() ||
+      vm.count("shards")) {
+    // every safe source is counted (or enumerated)
+    exponential::enabled = true;
+  }
+
+  if (jobs == 0) {
+    // one file per core
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  if (parallel::threads == 0) {
+    // one thread per core
+    parallel::threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  if (vm.count("resume")) {
+    try {
+      load_checkpoint(vm["resume"].as<std::string>());
+    } catch (const std::exception& e) {
+      std::cerr << "Error: " << e.what() << "." << std::endl;
+
+      return 1;
+    }
+  }
+
   if (vm.count("help")) {
     // help option specified
     std::cerr << general_options << std::endl;
@@ -114,7 +961,7 @@ int main(int argc, const char* argv[]) {
     return 1;
   }
 
-  if (!vm.count("files")) {
+  if (!vm.count("files") && !vm.count("files-from")) {
     // no input files specified
     std::cerr << "Error: No input file specified." << std::endl
               << "Try '" << argv[0] << " --help' for more information."
@@ -123,8 +970,41 @@ int main(int argc, const char* argv[]) {
     return 1;
   }
 
-  if (files.size() > 1) {
-    std::cout << "Running PPP on " << files.size() << " files." << std::endl
+  // the manifest, read one line at a time while the files are reduced
+  std::ifstream manifest_file;
+  std::istream* manifest = nullptr;
+
+  if (vm.count("files-from")) {
+    const auto& manifest_name = vm["files-from"].as<std::string>();
+
+    if (manifest_name == "-") {
+      manifest = &std::cin;
+    } else {
+      manifest_file.open(manifest_name);
+
+      if (!manifest_file) {
+        std::cerr << "Error: Failed to open the list of files '"
+                  << manifest_name << "'." << std::endl;
+
+        return 1;
+      }
+
+      manifest = &manifest_file;
+    }
+  }
+
+  // the files are opened, and the containers replaced by their matrices,
+  // while the instances are reduced
+  InstanceSource source(std::move(files), manifest, first, last);
+
+  if (manifest != nullptr) {
+    std::cout << "Running PPP on the files listed in "
+              << (manifest == &std::cin ? std::string("the standard input")
+                                        : vm["files-from"].as<std::string>())
+              << "." << std::endl
+              << std::endl;
+  } else if (source.size() > 1) {
+    std::cout << "Running PPP on " << source.size() << " files." << std::endl
               << std::endl;
   }
 
@@ -139,129 +1019,52 @@ int main(int argc, const char* argv[]) {
     pymod = boost::python::import("check_reduction");
   }
 
-  size_t count_file = 0;
-  for (const auto& file : files) {
-    // for each filename in files
-
-    if (logging::enabled) {
-      // verbosity enabled
-      std::cout << "F  (" << file << ")" << std::endl;
-    } else {
-      // verbosity disabled
-      if (files.size() > 1) {
-        const auto d_perc = std::floor(100.0 * count_file / files.size());
-        const auto perc = static_cast<size_t>(d_perc);
-
-        if (perc < 10) std::cout << " ";
-
-        std::cout << "\033[32m" << perc << "\033[39m (" << file << ")"
-                  << std::flush;
-      } else {
-        std::cout << "F  (" << file << ")" << std::flush;
-      }
-    }
-
-    count_file++;
-
-    RBGraph g{};
+  if (jobs > 1) {
+    // the files are read, reduced and printed by a pipeline of threads: the
+    // verbose output of the algorithm is omitted, since the outputs of the
+    // files would be interleaved
+    pipeline(std::cout, source, jobs, vm, pymod);
+  } else {
+    Instance instance;
 
     try {
-      read_graph(file, g);
-
-      std::stringstream keep_c{};
-
-      if (vm["maximal"].as<bool>()) {
-        const auto gm = maximal_reducible_graph(g);
-
-        if (vm["testpy"].as<bool>()) {
-          RBVertexIter v, v_end;
-          std::tie(v, v_end) = vertices(gm);
-          for (; v != v_end; ++v) {
-            if (!is_character(*v, gm)) continue;
-
-            keep_c << g[*v].name.substr(1) << " ";
-          }
-        }
-
-        g.clear();
-        copy_graph(gm, g);
-      }
-
-      const auto output = reduce(g);
-
-      std::stringstream reduction;
-      for (const auto& sc : output) {
-        reduction << sc << " ";
-      }
-
-      if (vm["testpy"].as<bool>()) {
-        if (vm["maximal"].as<bool>()) {
-          // run the function check_reduction(filename, reduction), store its
-          // output in pycheck
-          const auto pycheck = pymod.attr("check_reduction")(
-              file, reduction.str(), keep_c.str());
-
-          if (!boost::python::extract<bool>(pycheck)())
-            // check_reduction(filename, reduction) returned False
-            throw NoReduction();
-        } else {
-          // run the function check_reduction(filename, reduction), store its
-          // output in pycheck
-          const auto pycheck =
-              pymod.attr("check_reduction")(file, reduction.str());
-
-          if (!boost::python::extract<bool>(pycheck)())
-            // check_reduction(filename, reduction) returned False
-            throw NoReduction();
-        }
-      }
-
-      if (!logging::enabled) {
-        // verbosity disabled
-        std::cout << '\r';
-      }
-
-      std::cout << "Ok (" << file << ")";
+      while (source.next(instance)) {
+        // for each instance in source
+        if (instance.container && (vm.count("checkpoint") || vm.count("resume")) &&
+            std::min(last, instance.container->size()) != first + 1) {
+          // the state of the search is saved for a single graph
+          std::cerr << "Error: --checkpoint and --resume need a single matrix."
+                    << std::endl;
 
-      if (logging::enabled) {
-        // verbosity enabled
-        if (exponential::enabled) {
-          // exponential algorithm enabled
-          std::cout << ": Successful reductions have been logged";
-        } else {
-          std::cout << ": < " << reduction.str() << ">";
+          return 1;
         }
-      }
-
-      std::cout << std::endl;
-    } catch (const boost::python::error_already_set& e) {
-      if (!logging::enabled) {
-        // verbosity disabled
-        std::cout << '\r';
-      }
-
-      std::cout << "No (" << file << ")";
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << ": Python error";
+        progress(std::cout, instance.name, instance.order, source.size(),
+                 logging::enabled);
+        solve(std::cout, instance, vm, pymod, logging::enabled);
       }
+    } catch (const CheckpointMismatch& e) {
+      // the search can't be resumed on this matrix
+      std::cerr << std::endl << "Error: " << e.what() << "." << std::endl;
 
-      std::cout << std::endl;
-    } catch (const std::exception& e) {
-      if (!logging::enabled) {
-        // verbosity disabled
-        std::cout << '\r';
-      }
-
-      std::cout << "No (" << file << ")";
+      return 1;
+    }
+  }
 
-      if (logging::enabled) {
-        // verbosity enabled
-        std::cout << ": " << e.what();
-      }
+  if (vm["stats"].as<bool>()) {
+    // print the statistics of the safe source ordering
+    std::cout << std::endl
+              << "First safe source successful in "
+              << ordering_stats().successes << " of "
+              << ordering_stats().choices << " choices (order: "
+              << vm["order"].as<std::string>() << ")" << std::endl;
 
-      std::cout << std::endl;
+    if (memory::limit > 0) {
+      // print the statistics of the memory budget
+      std::cout << "Peak memory " << memory_budget().peak() << " of "
+                << memory::limit << " bytes, " << memory_budget().evictions
+                << " memo entries evicted, " << memory_budget().lean
+                << " choices without copies" << std::endl;
     }
   }
 
@@ -0,0 +1,1719 @@
+#include "matrix.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <zlib.h>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace {
+/**
+  @brief Check if \e c is a whitespace character (in the "C" locale)
+
+  @param[in] c Character
+
+  @return True if \e c is a whitespace character
+*/
+bool is_space(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+/**
+  @brief Read an unsigned number from [\e it, \e end), skipping the leading
+         whitespace
+
+  @param[in,out] it    First character to read, then the first character after
+                       the number
+  @param[in]     end   End of the text
+  @param[out]    value Number read, or 0 if there was no number
+
+  @return True if a number was read
+*/
+bool read_size(const char*& it, const char* end, size_t& value) {
+  value = 0;
+
+  while (it != end && is_space(*it)) ++it;
+
+  if (it == end || *it < '0' || *it > '9') return false;
+
+  for (; it != end && *it >= '0' && *it <= '9'; ++it) {
+    const size_t digit = *it - '0';
+
+    if (value > (std::numeric_limits<size_t>::max() - digit) / 10) {
+      // overflow
+      value = 0;
+
+      return false;
+    }
+
+    value = value * 10 + digit;
+  }
+
+  return true;
+}
+/**
+  @brief Add the vertices of a matrix of \e num_species species (or rows, if
+         collapsed) and \e num_characters characters to \e g
+
+  A collapsed row is named after its first species, and the other species are
+  recorded in the duplicates of \e g.
+
+  @param[in]  num_species    Number of species (or rows)
+  @param[in]  num_characters Number of characters
+  @param[in]  members        Species of every row, if the rows are collapsed
+  @param[out] species        Species vertices, by row
+  @param[out] characters     Character vertices, by index
+  @param[out] g              Red-black graph
+*/
+void add_vertices(const size_t num_species, const size_t num_characters,
+                  const std::vector<std::vector<size_t>>& members,
+                  std::vector<RBVertex>& species,
+                  std::vector<RBVertex>& characters, RBGraph& g) {
+  species.resize(num_species);
+  characters.resize(num_characters);
+
+  // insert species in the graph
+  for (size_t s = 0; s < num_species; ++s) {
+    const size_t name = (members.empty() ? s : members[s].front());
+
+    species[s] = add_vertex("s" + std::to_string(name), Type::species, g);
+  }
+
+  auto duplicates = std::make_shared<RBDuplicateMap>();
+
+  for (const auto& row : members) {
+    if (row.size() < 2) continue;
+
+    auto& names = (*duplicates)["s" + std::to_string(row.front())];
+
+    for (auto s = std::next(row.cbegin()); s != row.cend(); ++s) {
+      names.push_back("s" + std::to_string(*s));
+    }
+  }
+
+  if (!duplicates->empty()) g[boost::graph_bundle].duplicates = duplicates;
+
+  // insert characters in the graph
+  for (size_t c = 0; c < num_characters; ++c) {
+    characters[c] = add_vertex("c" + std::to_string(c), Type::character, g);
+  }
+}
+
+const char sparse_magic[6] = {'s', 'p', 'a', 'r', 's', 'e'};  ///< First word
+
+/**
+  @brief Header of a packed matrix
+*/
+struct PackedHeader {
+  char magic[4];        ///< Magic number, "PPPM"
+  uint32_t version;     ///< Format version
+  uint64_t species;     ///< Number of rows
+  uint64_t characters;  ///< Number of columns
+  uint32_t flags;       ///< Flags (red_plane)
+  uint32_t reserved;    ///< Unused, 0
+};
+
+static_assert(sizeof(PackedHeader) == 32, "unexpected packed header size");
+
+const char packed_magic[4] = {'P', 'P', 'P', 'M'};  ///< Magic number
+const uint32_t packed_version = 1;                   ///< Current version
+const uint32_t red_plane = 1;  ///< Flag: the red edges follow the rows
+
+/**
+  @brief Header of a container
+*/
+struct ContainerHeader {
+  char magic[4];      ///< Magic number, "PPPC"
+  uint32_t version;   ///< Format version
+  uint64_t count;     ///< Number of matrices
+  uint64_t index;     ///< Offset of the index
+  uint64_t reserved;  ///< Unused, 0
+};
+
+static_assert(sizeof(ContainerHeader) == 32,
+              "unexpected container header size");
+
+const char container_magic[4] = {'P', 'P', 'P', 'C'};  ///< Magic number
+const uint32_t container_version = 1;                   ///< Current version
+const size_t entry_words = 4;  ///< Words of an index entry
+
+/**
+  @brief Convert \e value between the byte order of the host and little-endian
+
+  @param[in] value Value
+
+  @return Converted value
+*/
+template <typename T>
+T little_endian(const T value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  T output;
+  const auto* in = reinterpret_cast<const char*>(&value);
+  auto* out = reinterpret_cast<char*>(&output);
+
+  std::reverse_copy(in, in + sizeof(T), out);
+
+  return output;
+#else
+  return value;
+#endif
+}
+
+/**
+  @brief Copy \e count words from \e data into \e words, as little-endian
+
+  @param[in]  data  Packed words
+  @param[in]  count Number of words
+  @param[out] words Words
+*/
+void load_words(const char* data, const size_t count,
+                std::vector<uint64_t>& words) {
+  words.resize(count);
+  std::memcpy(words.data(), data, count * sizeof(uint64_t));
+
+  for (auto& word : words) {
+    word = little_endian(word);
+  }
+}
+
+/**
+  @brief Write the words in \e words on \e os, as little-endian
+
+  @param[in] os    Output stream
+  @param[in] words Words
+*/
+void store_words(std::ostream& os, const std::vector<uint64_t>& words) {
+  for (const auto word : words) {
+    const auto value = little_endian(word);
+
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+}
+
+/**
+  @brief Combine \e value into the hash \e seed
+
+  @param[in] seed  Hash
+  @param[in] value Value
+
+  @return Combined hash
+*/
+uint64_t hash_combine(const uint64_t seed, const uint64_t value) {
+  return seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6) + (seed >> 2));
+}
+
+/**
+  @brief Set of the distinct rows of a matrix, indexed by the hash of their
+         cells
+*/
+class RowSet {
+ public:
+  /**
+    @brief Return the row of the set with the same cells as \e row, adding
+           \e row to the set if there is none
+
+    @param[in] row   Row
+    @param[in] hash  Hash of the cells of \e row
+    @param[in] equal Predicate that checks if two rows have the same cells
+
+    @return Row with the same cells as \e row (\e row itself if it is the
+            first one)
+  */
+  template <typename Equal>
+  size_t insert(const size_t row, const uint64_t hash, Equal equal) {
+    const auto range = m_rows.equal_range(hash);
+
+    for (auto it = range.first; it != range.second; ++it) {
+      if (equal(it->second, row)) return it->second;
+    }
+
+    m_rows.emplace(hash, row);
+
+    return row;
+  }
+
+ private:
+  std::unordered_multimap<uint64_t, size_t> m_rows;  ///< Rows, by hash
+};
+
+/**
+  @brief Collapse the row \e row of \e m, which holds the cells of the species
+         \e s, into the rows before it
+
+  @param[in,out] m    Matrix
+  @param[in,out] rows Distinct rows before \e row
+  @param[in]     row  Row
+  @param[in]     s    Species index
+
+  @return True if \e row is the first row with its cells, and must be kept
+*/
+bool collapse_row(Matrix& m, RowSet& rows, const size_t row, const size_t s) {
+  uint64_t hash = 0;
+
+  for (size_t w = row * m.words; w < (row + 1) * m.words; ++w) {
+    hash = hash_combine(hash, m.ones[w]);
+
+    if (!m.reds.empty()) hash = hash_combine(hash, m.reds[w]);
+  }
+
+  const auto equal = [&m](const size_t a, const size_t b) {
+    const auto same = [&m](const std::vector<uint64_t>& words, const size_t a,
+                           const size_t b) {
+      return std::equal(words.cbegin() + a * m.words,
+                        words.cbegin() + (a + 1) * m.words,
+                        words.cbegin() + b * m.words);
+    };
+
+    return same(m.ones, a, b) && (m.reds.empty() || same(m.reds, a, b));
+  };
+
+  const size_t first = rows.insert(row, hash, equal);
+
+  if (first != row) {
+    // duplicate row
+    m.members[first].push_back(s);
+
+    return false;
+  }
+
+  m.members.push_back({s});
+
+  return true;
+}
+
+/**
+  @brief Tokenizer of the cells of a matrix, which packs them by row
+*/
+class Tokenizer {
+ public:
+  /**
+    @brief Constructor
+
+    @param[in,out] m        Matrix, whose size and words are already set
+    @param[in]     collapse True if the duplicate rows are collapsed as soon
+                            as they are read
+
+    If the words of \e m hold less rows than its size, they grow with the
+    (distinct) rows read.
+  */
+  Tokenizer(Matrix& m, const bool collapse = false)
+      : m_matrix(m),
+        m_collapse(collapse),
+        m_row(0),
+        m_slot(0),
+        m_col(0),
+        m_count(0) {}
+
+  /**
+    @brief Append \e n cells to the matrix
+
+    @param[in] ones Bits of the cells (1 if the cell is not 0), from the
+                    lowest one
+    @param[in] n    Number of cells (at most 32)
+
+    @throw std::runtime_error if a cell that is not 0 overflows the matrix
+  */
+  void append(uint64_t ones, size_t n) {
+    while (n > 0) {
+      if (m_row == m_matrix.species) {
+        // the cells that overflow the matrix must be 0
+        if (ones != 0) {
+          // input file parsing error
+          throw std::runtime_error(
+              "Failed to read graph from file: oversized matrix");
+        }
+
+        m_count += n;
+
+        return;
+      }
+
+      // cells that fit in the current row
+      const size_t k = std::min(n, m_matrix.characters - m_col);
+      const uint64_t bits = ones & ((uint64_t(1) << k) - 1);
+
+      if (bits != 0) set(m_matrix.ones, bits, k);
+
+      m_col += k;
+      m_count += k;
+      n -= k;
+      ones >>= k;
+
+      if (m_col == m_matrix.characters) next_row();
+    }
+  }
+
+  /**
+    @brief Read the cells in [\e it, \e end), one byte at a time
+
+    @param[in] it  First byte
+    @param[in] end End of the bytes
+
+    @throw std::runtime_error if an unexpected value is found
+  */
+  void scalar(const char* it, const char* const end) {
+    for (; it != end; ++it) {
+      const char value = *it;
+
+      if (is_space(value)) continue;
+
+      switch (value) {
+#ifdef DEBUG
+        case '2':
+          // permit red edges from input matrix only if debugging
+          if (m_row < m_matrix.species && !m_matrix.ones.empty()) {
+            if (m_matrix.reds.empty())
+              m_matrix.reds.assign(m_matrix.ones.size(), 0);
+
+            set(m_matrix.reds, 1, 1);
+          }
+#endif
+
+        case '1':
+          append(1, 1);
+          break;
+
+        case '0':
+          append(0, 1);
+          break;
+
+        default:
+          // input file parsing error
+          throw std::runtime_error(
+              "Failed to read graph from file: unexpected value in matrix");
+      }
+    }
+  }
+
+  /**
+    @brief Return the number of cells read
+
+    @return Number of cells read
+  */
+  size_t count() const { return m_count; }
+
+ private:
+  /**
+    @brief Move to the next row, once the current one is complete
+  */
+  void next_row() {
+    m_row++;
+    m_col = 0;
+
+    if (m_matrix.ones.empty()) {
+      // the cells are not stored
+      m_slot++;
+
+      return;
+    }
+
+    const size_t first = m_slot * m_matrix.words;
+    const size_t last = first + m_matrix.words;
+
+    if (m_collapse && !collapse_row(m_matrix, m_rows, m_slot, m_row - 1)) {
+      // the next row is read in place of the duplicate one
+      std::fill(m_matrix.ones.begin() + first, m_matrix.ones.begin() + last, 0);
+
+      if (!m_matrix.reds.empty())
+        std::fill(m_matrix.reds.begin() + first, m_matrix.reds.begin() + last,
+                  0);
+
+      return;
+    }
+
+    m_slot++;
+
+    if (m_row < m_matrix.species && m_matrix.ones.size() == last) {
+      // the words of the next row
+      m_matrix.ones.resize(last + m_matrix.words, 0);
+
+      if (!m_matrix.reds.empty()) m_matrix.reds.resize(last + m_matrix.words, 0);
+    }
+  }
+
+  /**
+    @brief Set the \e k \e bits of the cells from the current one in \e words
+
+    @param[in,out] words Packed rows (not stored if empty)
+    @param[in]     bits  Bits of the cells
+    @param[in]     k     Number of cells (at most 32, in the current row)
+  */
+  void set(std::vector<uint64_t>& words, const uint64_t bits, const size_t k) {
+    if (words.empty()) return;
+
+    const size_t w = m_slot * m_matrix.words + m_col / 64;
+    const size_t offset = m_col % 64;
+
+    words[w] |= bits << offset;
+
+    if (offset + k > 64) words[w + 1] |= bits >> (64 - offset);
+  }
+
+  Matrix& m_matrix;  ///< Matrix
+  bool m_collapse;   ///< True if the duplicate rows are collapsed
+  RowSet m_rows;     ///< Distinct rows read, if collapsed
+  size_t m_row;      ///< Row of the next cell
+  size_t m_slot;     ///< Row of the next cell in the words of the matrix
+  size_t m_col;      ///< Column of the next cell
+  size_t m_count;    ///< Number of cells read
+};
+
+#ifdef __SSE2__
+/**
+  @brief Return the bits of \e bits at the positions of the bits of \e mask,
+         packed from the lowest one
+
+  @param[in] bits 16 bits
+  @param[in] mask Positions of the bits to extract
+
+  @return Extracted bits
+*/
+uint32_t extract_bits(uint32_t bits, uint32_t mask) {
+  if (mask == 0xFFFF) return bits;
+
+  if (mask == 0x5555 || mask == 0xAAAA) {
+    // cells separated by one whitespace: keep every other bit
+    if (mask == 0xAAAA) bits >>= 1;
+
+    bits &= 0x5555;
+    bits = (bits | (bits >> 1)) & 0x3333;
+    bits = (bits | (bits >> 2)) & 0x0F0F;
+    bits = (bits | (bits >> 4)) & 0x00FF;
+
+    return bits;
+  }
+
+  uint32_t output = 0;
+
+  for (size_t i = 0; mask != 0; mask &= mask - 1, ++i) {
+    output |= ((bits >> __builtin_ctz(mask)) & 1) << i;
+  }
+
+  return output;
+}
+
+/**
+  @brief Read the cells in [\e it, \e end), 16 bytes at a time (SSE2)
+
+  @param[in,out] tokenizer Tokenizer
+  @param[in]     it        First byte
+  @param[in]     end       End of the bytes
+
+  @return First byte that has not been read (less than 16 bytes from \e end)
+*/
+const char* tokenize_sse2(Tokenizer& tokenizer, const char* it,
+                          const char* const end) {
+  const __m128i zero = _mm_set1_epi8('0'), one = _mm_set1_epi8('1'),
+                blank = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t' - 1),
+                cr = _mm_set1_epi8('\r' + 1);
+
+  for (; end - it >= 16; it += 16) {
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+    const __m128i zeros = _mm_cmpeq_epi8(c, zero);
+    const __m128i ones = _mm_cmpeq_epi8(c, one);
+    const __m128i digits = _mm_or_si128(zeros, ones);
+    // ' ', and from '\t' to '\r'
+    const __m128i spaces =
+        _mm_or_si128(_mm_cmpeq_epi8(c, blank),
+                     _mm_and_si128(_mm_cmpgt_epi8(c, tab),
+                                   _mm_cmplt_epi8(c, cr)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(digits, spaces)) != 0xFFFF) {
+      // unexpected values (or red edges): one byte at a time
+      tokenizer.scalar(it, it + 16);
+      continue;
+    }
+
+    const uint32_t cells = _mm_movemask_epi8(digits);
+
+    tokenizer.append(extract_bits(_mm_movemask_epi8(ones), cells),
+                     __builtin_popcount(cells));
+  }
+
+  return it;
+}
+
+/**
+  @brief Read the cells in [\e it, \e end), 32 bytes at a time (AVX2, with
+         the bits of the cells extracted by BMI2)
+
+  @param[in,out] tokenizer Tokenizer
+  @param[in]     it        First byte
+  @param[in]     end       End of the bytes
+
+  @return First byte that has not been read (less than 32 bytes from \e end)
+*/
+__attribute__((target("avx2,bmi2"))) const char* tokenize_avx2(
+    Tokenizer& tokenizer, const char* it, const char* const end) {
+  const __m256i zero = _mm256_set1_epi8('0'), one = _mm256_set1_epi8('1'),
+                blank = _mm256_set1_epi8(' '),
+                tab = _mm256_set1_epi8('\t' - 1),
+                cr = _mm256_set1_epi8('\r' + 1);
+
+  for (; end - it >= 32; it += 32) {
+    const __m256i c =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+    const __m256i zeros = _mm256_cmpeq_epi8(c, zero);
+    const __m256i ones = _mm256_cmpeq_epi8(c, one);
+    const __m256i digits = _mm256_or_si256(zeros, ones);
+    // ' ', and from '\t' to '\r'
+    const __m256i spaces = _mm256_or_si256(
+        _mm256_cmpeq_epi8(c, blank),
+        _mm256_and_si256(_mm256_cmpgt_epi8(c, tab),
+                         _mm256_cmpgt_epi8(cr, c)));
+
+    if (static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(digits, spaces))) != 0xFFFFFFFF) {
+      // unexpected values (or red edges): one byte at a time
+      tokenizer.scalar(it, it + 32);
+      continue;
+    }
+
+    const uint32_t cells = _mm256_movemask_epi8(digits);
+
+    tokenizer.append(_pext_u32(_mm256_movemask_epi8(ones), cells),
+                     __builtin_popcount(cells));
+  }
+
+  return it;
+}
+#endif
+
+/**
+  @brief Read the number of species and characters of a matrix from its first
+         line [\e it, \e eol) into \e m
+
+  @param[in]  it  First character of the line
+  @param[in]  eol End of the line
+  @param[out] m   Matrix (size and words)
+
+  @return Number of cells of the matrix (saturated)
+
+  @throw std::runtime_error if the line is badly formatted
+*/
+size_t read_header(const char* it, const char* const eol, Matrix& m) {
+  // read rows and columns (species and characters), and ignore the rest of
+  // the line
+  if (read_size(it, eol, m.species)) read_size(it, eol, m.characters);
+
+  if (m.species == 0 || m.characters == 0) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: badly formatted line 0");
+  }
+
+  m.words = (m.characters + 63) / 64;
+
+  return (m.species <= std::numeric_limits<size_t>::max() / m.characters
+              ? m.species * m.characters
+              : std::numeric_limits<size_t>::max());
+}
+
+/**
+  @brief Read the cells in [\e it, \e end) with the instruction set \e simd
+
+  @param[in,out] tokenizer Tokenizer
+  @param[in]     it        First byte
+  @param[in]     end       End of the bytes
+  @param[in]     simd      Instruction set of the tokenizer
+*/
+void tokenize(Tokenizer& tokenizer, const char* it, const char* const end,
+              const Simd simd) {
+#ifdef __SSE2__
+  // the instruction sets that are not supported are never used
+  switch (std::min(simd, simd_support())) {
+    case Simd::avx2:
+      it = tokenize_avx2(tokenizer, it, end);
+      break;
+
+    case Simd::sse2:
+      it = tokenize_sse2(tokenizer, it, end);
+      break;
+
+    case Simd::none:
+      break;
+  }
+#endif
+
+  // the last bytes
+  tokenizer.scalar(it, end);
+}
+
+/**
+  @brief Check that the \e cells of \e m have been read, and drop the words
+         of the duplicate rows if they are collapsed
+
+  @param[in]     tokenizer Tokenizer
+  @param[in]     cells     Number of cells of the matrix
+  @param[in]     collapse  True if the duplicate rows are collapsed
+  @param[in,out] m         Matrix
+
+  @throw std::runtime_error if the matrix is undersized
+*/
+void finish_matrix(const Tokenizer& tokenizer, const size_t cells,
+                   const bool collapse, Matrix& m) {
+  if (tokenizer.count() != cells) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: undersized matrix");
+  }
+
+  if (collapse) {
+    // the distinct rows
+    m.species = m.members.size();
+    m.ones.resize(m.species * m.words);
+
+    if (!m.reds.empty()) m.reds.resize(m.ones.size());
+  }
+}
+
+const size_t inflate_chunk = 1 << 18;  ///< Bytes inflated at a time
+
+/**
+  @brief Decompressor of gzip data held in memory, which inflates it one chunk
+         at a time
+*/
+class Inflater {
+ public:
+  /**
+    @brief Constructor
+
+    @param[in] data   Gzip data (one or more members)
+    @param[in] size   Size of the data, in bytes
+    @param[in] prefix Prefix of the error messages
+
+    @throw std::runtime_error if the decompressor cannot be initialized
+  */
+  Inflater(const char* data, const size_t size, const std::string& prefix)
+      : m_data(data), m_size(size), m_read(0), m_end(false), m_prefix(prefix) {
+    m_stream = z_stream();
+
+    if (inflateInit2(&m_stream, 16 + MAX_WBITS) != Z_OK) {
+      throw std::runtime_error(m_prefix + "cannot inflate gzip data");
+    }
+  }
+
+  /**
+    @brief Destructor
+  */
+  ~Inflater() { inflateEnd(&m_stream); }
+
+  Inflater(const Inflater&) = delete;
+  Inflater& operator=(const Inflater&) = delete;
+
+  /**
+    @brief Inflate the next bytes of the data into \e buffer
+
+    @param[out] buffer Buffer
+    @param[in]  size   Size of the buffer, in bytes
+
+    @return Number of bytes inflated, less than \e size only at the end of
+            the data
+
+    @throw std::runtime_error if the data is corrupted or truncated
+  */
+  size_t read(char* buffer, const size_t size) {
+    m_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    m_stream.avail_out = size;
+
+    while (m_stream.avail_out > 0 && !m_end) {
+      if (m_stream.avail_in == 0) {
+        if (m_read == m_size) {
+          // input file parsing error
+          throw std::runtime_error(m_prefix + "truncated gzip data");
+        }
+
+        // the compressed data is handed to zlib one chunk at a time
+        const size_t bytes = std::min(m_size - m_read, inflate_chunk);
+
+        m_stream.next_in =
+            reinterpret_cast<Bytef*>(const_cast<char*>(m_data + m_read));
+        m_stream.avail_in = bytes;
+        m_read += bytes;
+      }
+
+      const int status = inflate(&m_stream, Z_NO_FLUSH);
+
+      if (status == Z_STREAM_END) {
+        // the data can hold more than one member
+        if (m_stream.avail_in == 0 && m_read == m_size) {
+          m_end = true;
+        } else {
+          inflateReset(&m_stream);
+        }
+      } else if (status != Z_OK && status != Z_BUF_ERROR) {
+        // input file parsing error
+        throw std::runtime_error(m_prefix + "corrupted gzip data");
+      }
+    }
+
+    return size - m_stream.avail_out;
+  }
+
+ private:
+  z_stream m_stream;     ///< State of zlib
+  const char* m_data;    ///< Gzip data
+  size_t m_size;         ///< Size of the data
+  size_t m_read;         ///< Bytes of the data handed to zlib
+  bool m_end;            ///< True if the data has been inflated
+  std::string m_prefix;  ///< Prefix of the error messages
+};
+
+/**
+  @brief Check if the \e size bytes at \e data are gzip-compressed, by their
+         magic number
+
+  @param[in] data Contents of a file
+  @param[in] size Size of the contents, in bytes
+
+  @return True if the contents are gzip-compressed
+*/
+bool is_gzip(const char* data, const size_t size) {
+  return size >= 2 && static_cast<unsigned char>(data[0]) == 0x1F &&
+         static_cast<unsigned char>(data[1]) == 0x8B;
+}
+
+/**
+  @brief Inflate the rest of the data of \e inflater, appending it to
+         \e output
+
+  @param[in,out] inflater Decompressor
+  @param[in,out] output   Inflated data
+*/
+void inflate_all(Inflater& inflater, std::string& output) {
+  size_t bytes;
+
+  do {
+    const size_t size = output.size();
+
+    output.resize(size + inflate_chunk);
+    bytes = inflater.read(&output[size], inflate_chunk);
+    output.resize(size + bytes);
+  } while (bytes == inflate_chunk);
+}
+
+/**
+  @brief Inflate and discard the next \e bytes bytes of the data of
+         \e inflater
+
+  @param[in,out] inflater Decompressor
+  @param[in]     bytes    Number of bytes
+
+  @return Number of bytes discarded, less than \e bytes only at the end of
+          the data
+*/
+size_t skip(Inflater& inflater, const size_t bytes) {
+  std::string chunk(std::min(bytes, inflate_chunk), '\0');
+  size_t output = 0;
+
+  while (output < bytes) {
+    const size_t size = std::min(bytes - output, chunk.size());
+    const size_t read = inflater.read(&chunk[0], size);
+
+    output += read;
+
+    if (read < size) break;
+  }
+
+  return output;
+}
+
+/**
+  @brief Parse the text matrix inflated by \e inflater into \e m, one chunk
+         at a time
+
+  The chunk holding the first bytes has already been inflated into \e chunk.
+  The rows are stored as they are read, since the size of the text is not
+  known in advance.
+
+  @param[in,out] inflater Decompressor
+  @param[in,out] chunk    Chunk buffer, holding the first bytes
+  @param[in]     bytes    Number of the first bytes
+  @param[out]    m        Matrix
+  @param[in]     collapse True if the duplicate rows are collapsed
+
+  @throw std::runtime_error if the text is not a well-formed matrix
+*/
+void inflate_matrix(Inflater& inflater, std::string& chunk, size_t bytes,
+                    Matrix& m, const bool collapse) {
+  m = Matrix();
+
+  if (bytes == 0) {
+    // input file parsing error
+    throw std::runtime_error("Failed to read graph from file: empty file");
+  }
+
+  // the first line can span more than one chunk
+  std::string line;
+  const char* eol;
+
+  while ((eol = static_cast<const char*>(
+              std::memchr(chunk.data(), '\n', bytes))) == nullptr) {
+    line.append(chunk.data(), bytes);
+
+    if ((bytes = inflater.read(&chunk[0], chunk.size())) == 0) break;
+  }
+
+  const char* it = chunk.data() + bytes;
+
+  if (eol != nullptr) {
+    line.append(chunk.data(), eol);
+    it = eol;
+  }
+
+  const size_t cells = read_header(line.data(), line.data() + line.size(), m);
+
+  m.ones.assign(m.words, 0);
+
+  // read binary matrix
+  Tokenizer tokenizer(m, collapse);
+
+  while (bytes > 0) {
+    tokenize(tokenizer, it, chunk.data() + bytes, simd_support());
+
+    bytes = inflater.read(&chunk[0], chunk.size());
+    it = chunk.data();
+  }
+
+  finish_matrix(tokenizer, cells, collapse, m);
+}
+}  // namespace
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Stream of the matrices of a gzip-compressed container
+*/
+struct Container::Stream {
+  std::mutex mutex{};                    ///< Stream lock
+  std::unique_ptr<Inflater> inflater{};  ///< Decompressor
+  size_t position = 0;                   ///< Inflated bytes read so far
+};
+
+Container::Container(const std::string& filename)
+    : Container(std::make_shared<const MappedFile>(filename)) {}
+
+Container::Container(std::shared_ptr<const MappedFile> file)
+    : m_file(std::move(file)),
+      m_data(m_file->data()),
+      m_bytes(m_file->size()),
+      m_gzip(false),
+      m_meta{},
+      m_meta_offset(0),
+      m_stream{},
+      m_size(0),
+      m_index(0) {
+  if (!*m_file) {
+    // input file doesn't exist
+    throw std::runtime_error(
+        "Failed to read container from file: no such file or directory");
+  }
+
+  ContainerHeader header;
+
+  if (is_gzip(m_data, m_bytes)) {
+    // the matrices are inflated when they are read
+    m_gzip = true;
+    m_stream = std::make_unique<Stream>();
+
+    inflate_meta(reinterpret_cast<char*>(&header));
+  } else if (m_bytes >= sizeof(header)) {
+    std::memcpy(&header, m_data, sizeof(header));
+  }
+
+  if (m_bytes < sizeof(header) ||
+      std::memcmp(header.magic, container_magic, sizeof(container_magic)) !=
+          0) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read container from file: not a container");
+  }
+
+  if (little_endian(header.version) != container_version) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read container from file: unsupported version " +
+        std::to_string(little_endian(header.version)));
+  }
+
+  m_size = little_endian(header.count);
+  m_index = little_endian(header.index);
+
+  const size_t entry_bytes = entry_words * sizeof(uint64_t);
+
+  if (m_index < sizeof(header) || m_index > m_bytes ||
+      m_size > (m_bytes - m_index) / entry_bytes) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read container from file: truncated index");
+  }
+}
+
+Container::~Container() {}
+
+std::string Container::name(const size_t index) const {
+  const auto field = entry(index, 1);
+
+  return std::string(meta(field.first), field.second);
+}
+
+void Container::read(const size_t index, Matrix& m) const {
+  SparseMatrix sparse;
+
+  if (read(index, m, sparse)) expand_matrix(sparse, m);
+}
+
+bool Container::read(const size_t index, Matrix& m,
+                     SparseMatrix& sparse) const {
+  const auto field = entry(index, 0);
+
+  if (!m_gzip)
+    return load_matrix(m_data + field.first, field.second, m, sparse);
+
+  std::string matrix(field.second, '\0');
+
+  {
+    std::lock_guard<std::mutex> lock(m_stream->mutex);
+
+    if (!m_stream->inflater || m_stream->position > field.first) {
+      // the matrix is behind the stream: inflate from the beginning
+      m_stream->inflater = std::make_unique<Inflater>(
+          m_data, m_file->size(), "Failed to read container from file: ");
+      m_stream->position = 0;
+    }
+
+    m_stream->position += skip(*m_stream->inflater,
+                               field.first - m_stream->position);
+
+    if (m_stream->position != field.first ||
+        m_stream->inflater->read(&matrix[0], matrix.size()) != matrix.size()) {
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read container from file: truncated matrix");
+    }
+
+    m_stream->position += matrix.size();
+  }
+
+  return load_matrix(matrix.data(), matrix.size(), m, sparse);
+}
+
+std::pair<size_t, size_t> Container::entry(const size_t index,
+                                           const size_t field) const {
+  uint64_t words[2];
+  std::memcpy(words,
+              meta(m_index +
+                   (index * entry_words + 2 * field) * sizeof(uint64_t)),
+              sizeof(words));
+
+  const size_t offset = little_endian(words[0]), size = little_endian(words[1]);
+
+  if (offset > m_bytes || size > m_bytes - offset ||
+      (field == 1 && offset < m_meta_offset)) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read container from file: bad index entry " +
+        std::to_string(index));
+  }
+
+  return std::make_pair(offset, size);
+}
+
+const char* Container::meta(const size_t offset) const {
+  return (m_gzip ? m_meta.data() + (offset - m_meta_offset) : m_data + offset);
+}
+
+void Container::inflate_meta(char* header) {
+  const std::string prefix = "Failed to read container from file: ";
+  const size_t header_bytes = sizeof(ContainerHeader);
+
+  // first pass: the header, the index and the size of the container
+  Inflater inflater(m_data, m_file->size(), prefix);
+
+  m_bytes = inflater.read(header, header_bytes);
+
+  if (m_bytes < header_bytes)
+    // not a container, reported by the constructor
+    return;
+
+  ContainerHeader h;
+  std::memcpy(&h, header, sizeof(h));
+
+  if (std::memcmp(h.magic, container_magic, sizeof(container_magic)) != 0)
+    // not a container, reported by the constructor
+    return;
+
+  const size_t index = little_endian(h.index);
+
+  m_bytes += skip(inflater, std::max(index, header_bytes) - header_bytes);
+
+  if (m_bytes < index)
+    // truncated container, reported by the constructor
+    return;
+
+  m_meta_offset = index;
+  inflate_all(inflater, m_meta);
+  m_bytes += m_meta.size();
+
+  const size_t entry_bytes = entry_words * sizeof(uint64_t);
+  const size_t count =
+      std::min<size_t>(little_endian(h.count), m_meta.size() / entry_bytes);
+
+  // the names are stored between the matrices and the index
+  size_t names = index;
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t offset;
+    std::memcpy(&offset, m_meta.data() + i * entry_bytes + 2 * sizeof(uint64_t),
+                sizeof(offset));
+
+    if (little_endian(offset) >= header_bytes)
+      names = std::min<size_t>(names, little_endian(offset));
+  }
+
+  if (names == index) return;
+
+  // second pass: the names, before the index
+  Inflater names_inflater(m_data, m_file->size(), prefix);
+  skip(names_inflater, names);
+
+  std::string meta(index - names, '\0');
+  names_inflater.read(&meta[0], meta.size());
+
+  m_meta.insert(0, meta);
+  m_meta_offset = names;
+}
+
+ContainerWriter::ContainerWriter(std::ostream& os)
+    : m_os(os), m_start(os.tellp()) {
+  const ContainerHeader header{};
+
+  m_os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void ContainerWriter::add(const std::string& name, const Matrix& m) {
+  const uint64_t offset = m_os.tellp() - m_start;
+
+  pack_matrix(m_os, m);
+
+  // the bounds of the name are set by close()
+  m_index.insert(m_index.end(),
+                 {offset, m_os.tellp() - m_start - offset, 0, 0});
+  m_names.push_back(name);
+}
+
+void ContainerWriter::close() {
+  // names
+  for (size_t i = 0; i < m_names.size(); ++i) {
+    m_index[i * entry_words + 2] = m_os.tellp() - m_start;
+    m_index[i * entry_words + 3] = m_names[i].size();
+
+    m_os << m_names[i];
+  }
+
+  // index
+  ContainerHeader header{};
+
+  std::memcpy(header.magic, container_magic, sizeof(container_magic));
+  header.version = little_endian(container_version);
+  header.count = little_endian<uint64_t>(m_names.size());
+  header.index = little_endian<uint64_t>(m_os.tellp() - m_start);
+
+  store_words(m_os, m_index);
+
+  // header
+  const auto end = m_os.tellp();
+
+  m_os.seekp(m_start);
+  m_os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  m_os.seekp(end);
+}
+
+MappedFile::MappedFile(const std::string& filename)
+    : m_open(false), m_mapped(false), m_data(nullptr), m_size(0), m_buffer{} {
+  const int fd = open(filename.c_str(), O_RDONLY);
+
+  if (fd < 0) return;
+
+  m_open = true;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (data != MAP_FAILED) {
+      // the file is scanned once, from the beginning
+      madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+      m_mapped = true;
+      m_data = static_cast<const char*>(data);
+      m_size = st.st_size;
+    }
+  }
+
+  if (!m_mapped) {
+    // not a regular file (or an empty one): read it in memory
+    char chunk[65536];
+    ssize_t bytes;
+
+    while ((bytes = read(fd, chunk, sizeof(chunk))) > 0) {
+      m_buffer.append(chunk, bytes);
+    }
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+  }
+
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (m_mapped) munmap(const_cast<char*>(m_data), m_size);
+}
+
+//=============================================================================
+// Algorithm functions
+
+Simd simd_support() {
+#ifdef __SSE2__
+  static const Simd output =
+      (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2")
+           ? Simd::avx2
+           : Simd::sse2);
+
+  return output;
+#else
+  return Simd::none;
+#endif
+}
+
+void parse_matrix(const char* data, const size_t size, Matrix& m,
+                  const Simd simd, const bool collapse) {
+  const char* it = data;
+  const char* const end = data + size;
+
+  m = Matrix();
+
+  if (size == 0) {
+    // input file parsing error
+    throw std::runtime_error("Failed to read graph from file: empty file");
+  }
+
+  // the first line holds the size of the matrix
+  const char* eol = it;
+  while (eol != end && *eol != '\n') ++eol;
+
+  const size_t cells = read_header(it, eol, m);
+
+  it = eol;
+
+  // a complete matrix takes at least one byte per cell: the cells are stored
+  // only if they fit in the rest of the file, otherwise the matrix is just
+  // checked, since it will be undersized
+  const size_t left = end - it;
+  const bool fits = (m.species <= left / m.characters);
+
+  // the collapsed rows are stored as they are found
+  if (fits) m.ones.assign((collapse ? 1 : m.species) * m.words, 0);
+
+  // read binary matrix
+  Tokenizer tokenizer(m, collapse);
+  tokenize(tokenizer, it, end, simd);
+
+  finish_matrix(tokenizer, cells, collapse, m);
+}
+
+void collapse_rows(Matrix& m) {
+  // the rows are already collapsed
+  if (!m.members.empty()) return;
+
+  RowSet rows;
+  size_t kept = 0;
+
+  for (size_t s = 0; s < m.species; ++s) {
+    if (kept != s) {
+      // move the row next to the distinct rows before it
+      std::copy_n(m.ones.cbegin() + s * m.words, m.words,
+                  m.ones.begin() + kept * m.words);
+
+      if (!m.reds.empty())
+        std::copy_n(m.reds.cbegin() + s * m.words, m.words,
+                    m.reds.begin() + kept * m.words);
+    }
+
+    if (collapse_row(m, rows, kept, s)) kept++;
+  }
+
+  m.species = kept;
+  m.ones.resize(m.species * m.words);
+
+  if (!m.reds.empty()) m.reds.resize(m.ones.size());
+}
+
+void collapse_rows(SparseMatrix& m) {
+  // the rows are already collapsed
+  if (!m.members.empty()) return;
+
+  RowSet rows;
+
+  // bounds[r] = first cell of the distinct row r
+  std::vector<size_t> bounds{0};
+
+  const auto equal = [&m, &bounds](const size_t a, const size_t b) {
+    const auto same = [](const SparseMatrix::Cell& x,
+                         const SparseMatrix::Cell& y) {
+      return x.character == y.character && x.red == y.red;
+    };
+
+    return std::equal(m.cells.cbegin() + bounds[a],
+                      m.cells.cbegin() + bounds[a + 1],
+                      m.cells.cbegin() + bounds[b],
+                      m.cells.cbegin() + bounds[b + 1], same);
+  };
+
+  // the cells are sorted by species: every row is moved next to the distinct
+  // rows before it, unless it is a duplicate
+  size_t next = 0;
+
+  for (size_t s = 0; s < m.species; ++s) {
+    const size_t row = bounds.size() - 1;
+    size_t last = bounds.back();
+    uint64_t hash = 0;
+
+    for (; next < m.cells.size() && m.cells[next].species == s; ++next) {
+      auto cell = m.cells[next];
+      cell.species = row;
+
+      hash = hash_combine(hash, 2 * cell.character + cell.red);
+      m.cells[last++] = cell;
+    }
+
+    bounds.push_back(last);
+
+    const size_t first = rows.insert(row, hash, equal);
+
+    if (first != row) {
+      // duplicate row
+      m.members[first].push_back(s);
+      bounds.pop_back();
+
+      continue;
+    }
+
+    m.members.push_back({s});
+  }
+
+  m.species = m.members.size();
+  m.cells.resize(bounds.back());
+}
+
+void build_graph(const Matrix& m, RBGraph& g) {
+  std::vector<RBVertex> species, characters;
+  add_vertices(m.species, m.characters, m.members, species, characters, g);
+
+  // add the edges, by row
+  for (size_t s = 0; s < m.species; ++s) {
+    const auto* row = m.row(s);
+
+    for (size_t w = 0; w < m.words; ++w) {
+      for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+        const size_t c = w * 64 + __builtin_ctzll(bits);
+
+        add_edge(species[s], characters[c],
+                 (m.at(s, c) == 2 ? Color::red : Color::black), g);
+      }
+    }
+  }
+}
+
+void parse_sparse(const char* data, const size_t size, SparseMatrix& m) {
+  const char* it = data;
+  const char* const end = data + size;
+
+  m = SparseMatrix();
+
+  if (!is_sparse(data, size)) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: badly formatted line 0");
+  }
+
+  // read rows and columns (species and characters) after the first word, and
+  // ignore the rest of the first line
+  const char* eol = std::find(it, end, '\n');
+  it += sizeof(sparse_magic);
+
+  if (read_size(it, eol, m.species)) read_size(it, eol, m.characters);
+
+  if (m.species == 0 || m.characters == 0) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: badly formatted line 0");
+  }
+
+  // read the characters of the species, one line at a time
+  for (it = eol; it != end; it = eol) {
+    eol = std::find(++it, end, '\n');
+
+    size_t s;
+    if (!read_size(it, eol, s)) {
+      // empty line
+      if (it == eol) continue;
+
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read graph from file: unexpected value in matrix");
+    }
+
+    while (it != eol && is_space(*it)) ++it;
+
+    if (it == eol || *it != ':') {
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read graph from file: unexpected value in matrix");
+    }
+
+    ++it;
+
+    size_t c;
+    while (read_size(it, eol, c)) {
+      bool red = false;
+
+      if (it != eol && *it == '*') {
+#ifdef DEBUG
+        // permit red edges from input matrix only if debugging
+        red = true;
+        ++it;
+#else
+        // input file parsing error
+        throw std::runtime_error(
+            "Failed to read graph from file: unexpected value in matrix");
+#endif
+      }
+
+      if (it != eol && !is_space(*it)) {
+        // input file parsing error
+        throw std::runtime_error(
+            "Failed to read graph from file: unexpected value in matrix");
+      }
+
+      if (s >= m.species || c >= m.characters) {
+        // input file parsing error
+        throw std::runtime_error(
+            "Failed to read graph from file: oversized matrix");
+      }
+
+      m.cells.push_back({s, c, red});
+    }
+
+    if (it != eol) {
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read graph from file: unexpected value in matrix");
+    }
+  }
+
+  // sort the cells by row and column (they usually are already)
+  const auto less = [](const SparseMatrix::Cell& a,
+                       const SparseMatrix::Cell& b) {
+    return a.species < b.species ||
+           (a.species == b.species && a.character < b.character);
+  };
+
+  if (!std::is_sorted(m.cells.cbegin(), m.cells.cend(), less))
+    std::sort(m.cells.begin(), m.cells.end(), less);
+
+  const auto same = [](const SparseMatrix::Cell& a,
+                       const SparseMatrix::Cell& b) {
+    return a.species == b.species && a.character == b.character;
+  };
+
+  if (std::adjacent_find(m.cells.cbegin(), m.cells.cend(), same) !=
+      m.cells.cend()) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: duplicate value in matrix");
+  }
+}
+
+void build_graph(const SparseMatrix& m, RBGraph& g) {
+  std::vector<RBVertex> species, characters;
+  add_vertices(m.species, m.characters, m.members, species, characters, g);
+
+  // add the edges, by row
+  for (const auto& cell : m.cells) {
+    add_edge(species[cell.species], characters[cell.character],
+             (cell.red ? Color::red : Color::black), g);
+  }
+}
+
+void expand_matrix(const SparseMatrix& sparse, Matrix& m) {
+  m = Matrix();
+
+  m.species = sparse.species;
+  m.characters = sparse.characters;
+  m.words = (m.characters + 63) / 64;
+  m.ones.assign(m.species * m.words, 0);
+  m.members = sparse.members;
+
+  for (const auto& cell : sparse.cells) {
+    const size_t w = cell.species * m.words + cell.character / 64;
+    const uint64_t bit = uint64_t(1) << (cell.character % 64);
+
+    m.ones[w] |= bit;
+
+    if (cell.red) {
+      if (m.reds.empty()) m.reds.assign(m.ones.size(), 0);
+
+      m.reds[w] |= bit;
+    }
+  }
+}
+
+// File I/O
+
+bool is_packed(const char* data, const size_t size) {
+  return size >= sizeof(packed_magic) &&
+         std::memcmp(data, packed_magic, sizeof(packed_magic)) == 0;
+}
+
+void unpack_matrix(const char* data, const size_t size, Matrix& m) {
+  m = Matrix();
+
+  if (size < sizeof(PackedHeader)) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: truncated packed header");
+  }
+
+  PackedHeader header;
+  std::memcpy(&header, data, sizeof(header));
+
+  if (little_endian(header.version) != packed_version) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: unsupported packed version " +
+        std::to_string(little_endian(header.version)));
+  }
+
+  m.species = little_endian(header.species);
+  m.characters = little_endian(header.characters);
+
+  if (m.species == 0 || m.characters == 0) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: badly formatted packed header");
+  }
+
+  m.words = (m.characters + 63) / 64;
+
+  const bool reds = (little_endian(header.flags) & red_plane);
+  const size_t planes = (reds ? 2 : 1);
+  const size_t left = (size - sizeof(header)) / sizeof(uint64_t);
+
+  if (m.species > left / planes / m.words) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: undersized matrix");
+  }
+
+  const size_t count = m.species * m.words;
+
+  if (size != sizeof(header) + planes * count * sizeof(uint64_t)) {
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: oversized matrix");
+  }
+
+  load_words(data + sizeof(header), count, m.ones);
+
+  if (reds) {
+#ifdef DEBUG
+    // permit red edges from input matrix only if debugging
+    load_words(data + sizeof(header) + count * sizeof(uint64_t), count,
+               m.reds);
+#else
+    // input file parsing error
+    throw std::runtime_error(
+        "Failed to read graph from file: unexpected value in matrix");
+#endif
+  }
+
+  // the bits after the last character of a row, and the red edges that are
+  // not edges, are not cells
+  const uint64_t padding =
+      (m.characters % 64 == 0 ? 0 : ~uint64_t(0) << (m.characters % 64));
+
+  for (size_t s = 0; s < m.species; ++s) {
+    const size_t last = (s + 1) * m.words - 1;
+
+    if ((m.ones[last] & padding) != 0) {
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read graph from file: unexpected value in matrix");
+    }
+  }
+
+  for (size_t w = 0; w < m.reds.size(); ++w) {
+    if ((m.reds[w] & ~m.ones[w]) != 0) {
+      // input file parsing error
+      throw std::runtime_error(
+          "Failed to read graph from file: unexpected value in matrix");
+    }
+  }
+}
+
+bool is_sparse(const char* data, const size_t size) {
+  return size >= sizeof(sparse_magic) &&
+         std::memcmp(data, sparse_magic, sizeof(sparse_magic)) == 0 &&
+         (size == sizeof(sparse_magic) || is_space(data[sizeof(sparse_magic)]));
+}
+
+void load_matrix(const char* data, const size_t size, Matrix& m,
+                 const bool collapse) {
+  SparseMatrix sparse;
+
+  if (load_matrix(data, size, m, sparse, collapse)) expand_matrix(sparse, m);
+}
+
+bool load_matrix(const char* data, const size_t size, Matrix& m,
+                 SparseMatrix& sparse, const bool collapse) {
+  if (is_gzip(data, size)) {
+    Inflater inflater(data, size, "Failed to read graph from file: ");
+
+    std::string chunk(inflate_chunk, '\0');
+    const size_t bytes = inflater.read(&chunk[0], chunk.size());
+
+    if (is_packed(chunk.data(), bytes) || is_sparse(chunk.data(), bytes)) {
+      // the packed and sparse matrices are inflated before they are loaded
+      chunk.resize(bytes);
+      inflate_all(inflater, chunk);
+
+      return load_matrix(chunk.data(), chunk.size(), m, sparse, collapse);
+    }
+
+    // the text matrices are parsed while they are inflated
+    inflate_matrix(inflater, chunk, bytes, m, collapse);
+  } else if (is_packed(data, size)) {
+    unpack_matrix(data, size, m);
+
+    if (collapse) collapse_rows(m);
+  } else if (is_sparse(data, size)) {
+    parse_sparse(data, size, sparse);
+
+    if (collapse) collapse_rows(sparse);
+
+    return true;
+  } else {
+    parse_matrix(data, size, m, simd_support(), collapse);
+  }
+
+  return false;
+}
+
+bool is_container(const char* data, const size_t size) {
+  char magic[sizeof(container_magic)];
+
+  if (is_gzip(data, size)) {
+    // only the magic number is inflated
+    try {
+      Inflater inflater(data, size, "");
+
+      if (inflater.read(magic, sizeof(magic)) != sizeof(magic)) return false;
+    } catch (const std::runtime_error& e) {
+      return false;
+    }
+  } else if (size >= sizeof(magic)) {
+    std::memcpy(magic, data, sizeof(magic));
+  } else {
+    return false;
+  }
+
+  return std::memcmp(magic, container_magic, sizeof(magic)) == 0;
+}
+
+bool is_container(const std::string& filename) {
+  const MappedFile file(filename);
+
+  return file && is_container(file.data(), file.size());
+}
+
+void read_matrix(const std::string& filename, Matrix& m) {
+  const MappedFile file(filename);
+
+  if (!file) {
+    // input file doesn't exist
+    throw std::runtime_error(
+        "Failed to read graph from file: no such file or directory");
+  }
+
+  load_matrix(file.data(), file.size(), m);
+}
+
+void write_matrix(std::ostream& os, const Matrix& m) {
+  os << m.species << " " << m.characters << std::endl;
+
+  std::string line(2 * m.characters, ' ');
+  line.back() = '\n';
+
+  for (size_t s = 0; s < m.species; ++s) {
+    for (size_t c = 0; c < m.characters; ++c) {
+      line[2 * c] = '0' + m.at(s, c);
+    }
+
+    os << line;
+  }
+}
+
+void pack_matrix(std::ostream& os, const Matrix& m) {
+  PackedHeader header;
+
+  std::memcpy(header.magic, packed_magic, sizeof(packed_magic));
+  header.version = little_endian(packed_version);
+  header.species = little_endian<uint64_t>(m.species);
+  header.characters = little_endian<uint64_t>(m.characters);
+  header.flags = little_endian<uint32_t>(m.reds.empty() ? 0 : red_plane);
+  header.reserved = 0;
+
+  os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  store_words(os, m.ones);
+  store_words(os, m.reds);
+}
+
+void write_sparse(std::ostream& os, const Matrix& m) {
+  os << "sparse " << m.species << " " << m.characters << std::endl;
+
+  for (size_t s = 0; s < m.species; ++s) {
+    const auto* row = m.row(s);
+
+    if (std::all_of(row, row + m.words, [](uint64_t w) { return w == 0; }))
+      // species with no characters
+      continue;
+
+    os << s << ":";
+
+    for (size_t w = 0; w < m.words; ++w) {
+      for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+        const size_t c = w * 64 + __builtin_ctzll(bits);
+
+        os << " " << c;
+
+        if (m.at(s, c) == 2) os << "*";
+      }
+    }
+
+    os << "\n";
+  }
+}
@@ -0,0 +1,528 @@
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "rbgraph.hpp"
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Read-only view of the contents of a file
+
+  Regular files are memory-mapped; the files that cannot be mapped (pipes,
+  character devices) are read in memory instead.
+*/
+class MappedFile {
+ public:
+  /**
+    @brief Constructor, mapping \e filename
+
+    @param[in] filename Filename
+  */
+  MappedFile(const std::string& filename);
+
+  /**
+    @brief Destructor, unmapping the file
+  */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+    @brief Check if the file has been opened
+
+    @return True if the file has been opened
+  */
+  explicit operator bool() const { return m_open; }
+
+  /**
+    @brief Return the first byte of the file
+
+    @return Pointer to the contents of the file
+  */
+  const char* data() const { return m_data; }
+
+  /**
+    @brief Return the size of the file
+
+    @return Size of the file, in bytes
+  */
+  size_t size() const { return m_size; }
+
+ private:
+  bool m_open;           ///< True if the file has been opened
+  bool m_mapped;         ///< True if m_data is a mapping
+  const char* m_data;      ///< Contents of the file
+  size_t m_size;           ///< Size of the contents
+  std::string m_buffer;  ///< Contents of the files that cannot be mapped
+};
+
+/**
+  @brief Binary matrix of species (rows) and characters (columns)
+
+  Every row is packed in 64-bit words, one bit per character: a cell is 1 if
+  its bit is set in \e ones, and 2 (a red edge, permitted in the input matrix
+  only when debugging) if its bit is also set in \e reds.
+  When the duplicate rows are collapsed, every distinct row is stored once,
+  with the species that have its cells in \e members.
+*/
+struct Matrix {
+  size_t species{};              ///< Number of rows
+  size_t characters{};           ///< Number of columns
+  size_t words{};                ///< Number of words of a row
+  std::vector<uint64_t> ones{};  ///< Cells that are not 0, by row
+  std::vector<uint64_t> reds{};  ///< Cells that are 2, by row (if any)
+  std::vector<std::vector<size_t>> members{};  ///< Species of every row, if
+                                               ///< the rows are collapsed
+
+  /**
+    @brief Return the words of the row of the species \e s
+
+    @param[in] s Species index
+
+    @return Pointer to the first word of the row
+  */
+  const uint64_t* row(const size_t s) const { return &ones[s * words]; }
+
+  /**
+    @brief Return the cell of the species \e s and the character \e c
+
+    @param[in] s Species index
+    @param[in] c Character index
+
+    @return Value of the cell
+  */
+  uint8_t at(const size_t s, const size_t c) const {
+    const size_t w = s * words + c / 64;
+    const uint64_t bit = uint64_t(1) << (c % 64);
+
+    if (!(ones[w] & bit)) return 0;
+
+    return (!reds.empty() && (reds[w] & bit) ? 2 : 1);
+  }
+};
+
+/**
+  @brief Sparse binary matrix of species (rows) and characters (columns)
+
+  Only the cells that are not 0 are stored, sorted by row and column: the
+  memory used by the matrix is proportional to the number of its edges.
+*/
+struct SparseMatrix {
+  /**
+    @brief Struct used to represent a cell that is not 0
+  */
+  struct Cell {
+    size_t species;    ///< Species index
+    size_t character;  ///< Character index
+    bool red;          ///< True if the cell is 2 (only when debugging)
+  };
+
+  size_t species{};           ///< Number of rows
+  size_t characters{};        ///< Number of columns
+  std::vector<Cell> cells{};  ///< Cells that are not 0
+  std::vector<std::vector<size_t>> members{};  ///< Species of every row, if
+                                               ///< the rows are collapsed
+};
+
+/**
+  @brief Read-only container of many matrices, with an index
+
+  A container is a 32-byte header (magic number "PPPC", version, number of
+  matrices, offset of the index) followed by the matrices, their names and the
+  index, which holds the offset and the size of every matrix and name.
+  The container is mapped once, and the index is checked only when a matrix is
+  accessed, so opening it doesn't depend on the number of matrices.
+  A gzip-compressed container is never inflated whole: only its names and
+  index are kept in memory, and the matrices are inflated one at a time by a
+  stream that moves forward through the container (reading the matrices out
+  of order restarts the stream).
+*/
+class Container {
+ public:
+  /**
+    @brief Constructor, mapping \e filename
+
+    @param[in] filename Filename
+
+    @throw std::runtime_error if the file is not a container
+  */
+  Container(const std::string& filename);
+
+  /**
+    @brief Constructor, for the already mapped \e file
+
+    @param[in] file Mapped file
+
+    @throw std::runtime_error if the file is not a container
+  */
+  Container(std::shared_ptr<const MappedFile> file);
+
+  /**
+    @brief Destructor
+  */
+  ~Container();
+
+  /**
+    @brief Return the number of matrices
+
+    @return Number of matrices
+  */
+  size_t size() const { return m_size; }
+
+  /**
+    @brief Return the name of the matrix \e index
+
+    @param[in] index Index of the matrix
+
+    @return Name of the matrix
+  */
+  std::string name(const size_t index) const;
+
+  /**
+    @brief Read the matrix \e index into \e m
+
+    @param[in]  index Index of the matrix
+    @param[out] m     Matrix
+  */
+  void read(const size_t index, Matrix& m) const;
+
+  /**
+    @brief Read the matrix \e index into \e m, or into \e sparse if it is in
+           the sparse format
+
+    @param[in]  index  Index of the matrix
+    @param[out] m      Matrix
+    @param[out] sparse Sparse matrix
+
+    @return True if the matrix was read into \e sparse
+  */
+  bool read(const size_t index, Matrix& m, SparseMatrix& sparse) const;
+
+ private:
+  struct Stream;
+
+  /**
+    @brief Return the bounds of the field \e field of the index entry
+           \e index, checked against the size of the file
+
+    @param[in] index Index of the matrix
+    @param[in] field 0 for the matrix, 1 for the name
+
+    @return Offset and size of the field
+  */
+  std::pair<size_t, size_t> entry(const size_t index,
+                                  const size_t field) const;
+
+  /**
+    @brief Return the byte at \e offset of the names or of the index
+
+    @param[in] offset Offset in the (inflated) container
+
+    @return Pointer to the byte
+  */
+  const char* meta(const size_t offset) const;
+
+  /**
+    @brief Inflate the header, the names and the index of a gzip-compressed
+           container
+
+    @param[out] header Header of the container
+  */
+  void inflate_meta(char* header);
+
+  std::shared_ptr<const MappedFile> m_file;  ///< Mapped container
+  const char* m_data;                        ///< Contents of the container
+                                             ///< (compressed, if gzip)
+  size_t m_bytes;                            ///< Size of the (inflated)
+                                             ///< contents
+  bool m_gzip;                               ///< True if gzip-compressed
+  std::string m_meta;                        ///< Inflated names and index
+  size_t m_meta_offset;                      ///< Offset of m_meta
+  mutable std::unique_ptr<Stream> m_stream;  ///< Stream of the matrices
+  size_t m_size;                             ///< Number of matrices
+  size_t m_index;                            ///< Offset of the index
+};
+
+/**
+  @brief Writer of a container, which appends the matrices one at a time
+
+  The index is kept in memory and written by close().
+*/
+class ContainerWriter {
+ public:
+  /**
+    @brief Constructor, writing a placeholder of the header
+
+    @param[in] os Output stream (binary, seekable)
+  */
+  ContainerWriter(std::ostream& os);
+
+  /**
+    @brief Append the matrix \e m, named \e name
+
+    @param[in] name Name of the matrix
+    @param[in] m    Matrix
+  */
+  void add(const std::string& name, const Matrix& m);
+
+  /**
+    @brief Write the names, the index and the header
+  */
+  void close();
+
+ private:
+  std::ostream& m_os;                  ///< Output stream
+  std::streampos m_start;              ///< Position of the header
+  std::vector<uint64_t> m_index{};     ///< Offsets and sizes of the matrices
+  std::vector<std::string> m_names{};  ///< Names of the matrices
+};
+
+/**
+  @brief Scoped enumeration type used for the instruction sets of the matrix
+         tokenizer
+*/
+enum class Simd {
+  none,  ///< Scalar tokenizer
+  sse2,  ///< 16 bytes at a time
+  avx2   ///< 32 bytes at a time (with BMI2)
+};
+
+//=============================================================================
+// Algorithm functions
+
+/**
+  @brief Return the best instruction set of the matrix tokenizer supported by
+         the processor
+
+  @return Instruction set
+*/
+Simd simd_support();
+
+/**
+  @brief Parse the matrix in the \e size bytes at \e data into \e m
+
+  The first line holds the number of species and characters, and the next
+  lines hold the cells, separated by any whitespace.
+  The cells are validated and packed by a vectorized tokenizer, which falls
+  back to a byte at a time around the unexpected values.
+  If \e collapse is true, every row is hashed as soon as it is read and only
+  the first row with the same cells is stored, so the memory used by the
+  matrix depends on the number of distinct rows.
+
+  @param[in]  data     Text of the matrix
+  @param[in]  size     Size of the text, in bytes
+  @param[out] m        Matrix
+  @param[in]  simd     Instruction set of the tokenizer
+  @param[in]  collapse True if the duplicate rows are collapsed
+
+  @throw std::runtime_error if the text is not a well-formed matrix
+*/
+void parse_matrix(const char* data, const size_t size, Matrix& m,
+                  const Simd simd = simd_support(),
+                  const bool collapse = false);
+
+/**
+  @brief Collapse the duplicate rows of \e m: only the first row with the
+         same cells is kept, with the species that have them in m.members
+
+  @param[in,out] m Matrix
+*/
+void collapse_rows(Matrix& m);
+
+/**
+  @brief Collapse the duplicate rows of \e m: only the first row with the
+         same cells is kept, with the species that have them in m.members
+
+  @param[in,out] m Sparse matrix
+*/
+void collapse_rows(SparseMatrix& m);
+
+/**
+  @brief Build the red-black graph of \e m into \e g
+
+  Species and characters are named after their row and column, and the edges
+  are added by row.
+  The species of a collapsed row are represented by the first one, and the
+  others are recorded in the duplicates of \e g.
+
+  @param[in]  m Matrix
+  @param[out] g Red-black graph
+*/
+void build_graph(const Matrix& m, RBGraph& g);
+
+/**
+  @brief Parse the sparse matrix in the \e size bytes at \e data into \e m
+
+  The first line is "sparse", followed by the number of species and
+  characters; every next line holds a species index, a colon and the indices
+  of the characters of the species (a '*' after a character index marks a red
+  edge, permitted only when debugging).
+  The species with no characters can be omitted, and the indices can be in
+  any order.
+
+  @param[in]  data Text of the sparse matrix
+  @param[in]  size Size of the text, in bytes
+  @param[out] m    Sparse matrix
+
+  @throw std::runtime_error if the text is not a well-formed sparse matrix
+*/
+void parse_sparse(const char* data, const size_t size, SparseMatrix& m);
+
+/**
+  @brief Build the red-black graph of \e m into \e g, in time proportional to
+         the number of edges
+
+  The vertices and the edges are added in the same order as build_graph()
+  adds them for the same (dense) matrix.
+
+  @param[in]  m Sparse matrix
+  @param[out] g Red-black graph
+*/
+void build_graph(const SparseMatrix& m, RBGraph& g);
+
+/**
+  @brief Copy the sparse matrix \e sparse into the dense matrix \e m
+
+  @param[in]  sparse Sparse matrix
+  @param[out] m      Matrix
+*/
+void expand_matrix(const SparseMatrix& sparse, Matrix& m);
+
+// File I/O
+
+/**
+  @brief Check if the \e size bytes at \e data hold a packed matrix, by its
+         magic number
+
+  @param[in] data Contents of a file
+  @param[in] size Size of the contents, in bytes
+
+  @return True if the contents are a packed matrix
+*/
+bool is_packed(const char* data, const size_t size);
+
+/**
+  @brief Load the packed matrix in the \e size bytes at \e data into \e m
+
+  A packed matrix is a 32-byte header (magic number "PPPM", version, number of
+  species and characters, flags) followed by the rows, packed in 64-bit
+  little-endian words, and by the same plane for the red edges if flagged.
+
+  @param[in]  data Packed matrix
+  @param[in]  size Size of the packed matrix, in bytes
+  @param[out] m    Matrix
+
+  @throw std::runtime_error if the contents are not a well-formed packed
+         matrix
+*/
+void unpack_matrix(const char* data, const size_t size, Matrix& m);
+
+/**
+  @brief Check if the \e size bytes at \e data hold a sparse matrix, by its
+         first word
+
+  @param[in] data Contents of a file
+  @param[in] size Size of the contents, in bytes
+
+  @return True if the contents are a sparse matrix
+*/
+bool is_sparse(const char* data, const size_t size);
+
+/**
+  @brief Load the matrix in the \e size bytes at \e data into \e m, in the
+         text, packed or sparse format
+
+  Gzip-compressed contents are inflated one chunk at a time: the text matrices
+  are parsed while they are inflated, so the inflated text is never held in
+  memory as a whole.
+
+  @param[in]  data     Contents of a file
+  @param[in]  size     Size of the contents, in bytes
+  @param[out] m        Matrix
+  @param[in]  collapse True if the duplicate rows are collapsed
+*/
+void load_matrix(const char* data, const size_t size, Matrix& m,
+                 const bool collapse = false);
+
+/**
+  @brief Load the matrix in the \e size bytes at \e data into \e m, or into
+         \e sparse if it is in the sparse format (gzip-compressed or not)
+
+  Unlike the other overload, the sparse matrices are not expanded, so the
+  graph can be built from their ones.
+
+  @param[in]  data     Contents of a file
+  @param[in]  size     Size of the contents, in bytes
+  @param[out] m        Matrix
+  @param[out] sparse   Sparse matrix
+  @param[in]  collapse True if the duplicate rows are collapsed
+
+  @return True if the matrix was loaded into \e sparse
+*/
+bool load_matrix(const char* data, const size_t size, Matrix& m,
+                 SparseMatrix& sparse, const bool collapse = false);
+
+/**
+  @brief Check if the \e size bytes at \e data are a container
+         (gzip-compressed or not), by their magic number
+
+  Only the first bytes of a gzip-compressed container are inflated.
+
+  @param[in] data Contents of a file
+  @param[in] size Size of the contents, in bytes
+
+  @return True if the contents are a container
+*/
+bool is_container(const char* data, const size_t size);
+
+/**
+  @brief Check if \e filename is a container (gzip-compressed or not), by its
+         magic number
+
+  @param[in] filename Filename
+
+  @return True if \e filename is a container
+*/
+bool is_container(const std::string& filename);
+
+/**
+  @brief Read from \e filename into \e m, in the text, packed or sparse format
+         (gzip-compressed or not)
+
+  @param[in]  filename Filename
+  @param[out] m        Matrix
+*/
+void read_matrix(const std::string& filename, Matrix& m);
+
+/**
+  @brief Write \e m on \e os in the text format
+
+  @param[in] os Output stream
+  @param[in] m  Matrix
+*/
+void write_matrix(std::ostream& os, const Matrix& m);
+
+/**
+  @brief Write \e m on \e os in the packed format
+
+  @param[in] os Output stream (binary)
+  @param[in] m  Matrix
+*/
+void pack_matrix(std::ostream& os, const Matrix& m);
+
+/**
+  @brief Write \e m on \e os in the sparse format
+
+  @param[in] os Output stream
+  @param[in] m  Matrix
+*/
+void write_sparse(std::ostream& os, const Matrix& m);
+
+#endif  // MATRIX_HPP
@@ -0,0 +1,121 @@
+#include "pool.hpp"
+
+namespace {
+thread_local const ThreadPool* t_pool = nullptr;  ///< Pool of the worker
+thread_local size_t t_index = 0;                  ///< Queue of the worker
+}  // namespace
+
+//=============================================================================
+// Auxiliary structs and classes
+
+ThreadPool::ThreadPool(const size_t threads)
+    : m_queues{}, m_workers{}, m_pending(0), m_done(false) {
+  // one queue per worker, plus the shared queue
+  for (size_t i = 0; i <= threads; ++i) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+
+  for (size_t i = 0; i < threads; ++i) {
+    m_workers.emplace_back(&ThreadPool::work, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_done = true;
+  }
+
+  m_idle.notify_all();
+
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+}
+
+bool ThreadPool::run_pending() {
+  std::function<void()> task;
+
+  if (!pop(queue_index(), task)) return false;
+
+  task();
+
+  return true;
+}
+
+void ThreadPool::push(std::function<void()> task) {
+  auto& queue = *m_queues[queue_index()];
+
+  // counted before being queued, so that m_pending never underflows
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending++;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+
+  m_idle.notify_one();
+}
+
+bool ThreadPool::pop(const size_t index, std::function<void()>& task) {
+  // own queue first, newest task
+  {
+    auto& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      m_pending--;
+
+      return true;
+    }
+  }
+
+  // steal the oldest task of another queue
+  for (size_t i = 1; i < m_queues.size(); ++i) {
+    auto& queue = *m_queues[(index + i) % m_queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      m_pending--;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::work(const size_t index) {
+  t_pool = this;
+  t_index = index;
+
+  std::function<void()> task;
+
+  while (true) {
+    if (pop(index, task)) {
+      task();
+      task = nullptr;
+
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_done || m_pending > 0; });
+
+    if (m_done && m_pending == 0) break;
+  }
+}
+
+size_t ThreadPool::queue_index() const {
+  if (t_pool == this) return t_index;
+
+  // the shared queue
+  return m_queues.size() - 1;
+}
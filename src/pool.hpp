@@ -0,0 +1,290 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Work-stealing thread pool
+
+  Every worker owns a queue of tasks: it runs the tasks it submitted itself
+  (newest first) and, when its queue is empty, it steals the oldest task of the
+  other queues.
+  Tasks submitted by threads that are not workers of the pool go to a shared
+  queue.
+
+  A thread that waits for the result of a task keeps running pending tasks in
+  the meantime, so tasks can submit other tasks and wait for them without
+  deadlocking the pool.
+*/
+class ThreadPool {
+ public:
+  /**
+    @brief Constructor, starting \e threads workers
+
+    @param[in] threads Number of worker threads
+  */
+  ThreadPool(const size_t threads);
+
+  /**
+    @brief Destructor, running the pending tasks and joining the workers
+  */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+    @brief Submit the task \e f to the pool
+
+    @param[in] f Callable object, with no arguments
+
+    @return Future result of \e f
+  */
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> submit(F f) {
+    typedef typename std::result_of<F()>::type R;
+
+    const auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+    auto output = task->get_future();
+
+    push([task]() { (*task)(); });
+
+    return output;
+  }
+
+  /**
+    @brief Wait for the result of a task, running pending tasks meanwhile
+
+    @param[in,out] f Future result of a task submitted to the pool
+
+    @return Result of the task
+  */
+  template <typename T>
+  T wait(std::future<T>& f) {
+    while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      if (!run_pending()) std::this_thread::yield();
+    }
+
+    return f.get();
+  }
+
+  /**
+    @brief Run one pending task, if any
+
+    @return True if a task was run
+  */
+  bool run_pending();
+
+  /**
+    @brief Return the number of worker threads
+
+    @return Number of worker threads
+  */
+  size_t size() const { return m_workers.size(); }
+
+ private:
+  /**
+    @brief Struct used to represent the task queue of a thread
+  */
+  struct Queue {
+    std::mutex mutex{};                          ///< Queue lock
+    std::deque<std::function<void()>> tasks{};  ///< Pending tasks
+  };
+
+  /**
+    @brief Push the task \e task in the queue of the calling thread
+
+    @param[in] task Task
+  */
+  void push(std::function<void()> task);
+
+  /**
+    @brief Pop a task from the queue \e index, or steal one from the others
+
+    @param[in]  index Queue index of the calling thread
+    @param[out] task  Popped task
+
+    @return True if a task was popped
+  */
+  bool pop(const size_t index, std::function<void()>& task);
+
+  /**
+    @brief Main loop of the worker \e index
+
+    @param[in] index Queue index of the worker
+  */
+  void work(const size_t index);
+
+  /**
+    @brief Return the queue index of the calling thread
+
+    @return Queue index (the shared queue for threads that are not workers)
+  */
+  size_t queue_index() const;
+
+  std::vector<std::unique_ptr<Queue>> m_queues;  ///< Workers + shared queue
+  std::vector<std::thread> m_workers;            ///< Worker threads
+  std::atomic<size_t> m_pending;                 ///< Number of pending tasks
+  std::atomic<bool> m_done;                      ///< Stop toggle
+  std::mutex m_mutex;                            ///< Idle workers lock
+  std::condition_variable m_idle;                ///< Idle workers condition
+};
+
+/**
+  @brief Cooperative cancellation token
+
+  A token is cancelled when it, or one of its ancestors, has been cancelled:
+  tasks check it at safe points and stop their work.
+*/
+class CancellationToken {
+ public:
+  /**
+    @brief Constructor
+
+    @param[in] parent Token whose cancellation cancels this token, if any
+  */
+  CancellationToken(const CancellationToken* parent = nullptr)
+      : m_cancelled(false), m_parent(parent) {}
+
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  /**
+    @brief Cancel the token (and its descendants)
+  */
+  void cancel() { m_cancelled = true; }
+
+  /**
+    @brief Check if the token, or one of its ancestors, has been cancelled
+
+    @return True if the token has been cancelled
+  */
+  bool cancelled() const {
+    return m_cancelled || (m_parent != nullptr && m_parent->cancelled());
+  }
+
+ private:
+  std::atomic<bool> m_cancelled;            ///< Cancellation toggle
+  const CancellationToken* const m_parent;  ///< Parent token
+};
+
+/**
+  @brief Blocking FIFO queue with a fixed capacity
+
+  Producers wait while the queue is full and consumers wait while it is empty,
+  so a fast stage of a pipeline cannot run ahead of a slow one.
+  Once the queue is closed, producers fail and consumers drain the remaining
+  items.
+*/
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+    @brief Constructor
+
+    @param[in] capacity Maximum number of queued items
+  */
+  BoundedQueue(const size_t capacity)
+      : m_capacity(std::max<size_t>(capacity, 1)), m_closed(false) {}
+
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  /**
+    @brief Push \e item, waiting while the queue is full
+
+    @param[in] item Item
+
+    @return False if the queue has been closed (\e item is dropped)
+  */
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_full.wait(lock, [this]() {
+      return m_closed || m_items.size() < m_capacity;
+    });
+
+    if (m_closed) return false;
+
+    m_items.push_back(std::move(item));
+    lock.unlock();
+
+    m_not_empty.notify_one();
+
+    return true;
+  }
+
+  /**
+    @brief Pop the oldest item, waiting while the queue is empty
+
+    @param[out] item Popped item
+
+    @return False if the queue has been closed and is empty
+  */
+  bool pop(T& item) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_empty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+
+    if (m_items.empty()) return false;
+
+    item = std::move(m_items.front());
+    m_items.pop_front();
+    lock.unlock();
+
+    m_not_full.notify_one();
+
+    return true;
+  }
+
+  /**
+    @brief Close the queue, waking up the waiting producers and consumers
+  */
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+    }
+
+    m_not_full.notify_all();
+    m_not_empty.notify_all();
+  }
+
+  /**
+    @brief Return the number of queued items
+
+    @return Number of queued items
+  */
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_items.size();
+  }
+
+  /**
+    @brief Return the capacity of the queue
+
+    @return Maximum number of queued items
+  */
+  size_t capacity() const { return m_capacity; }
+
+ private:
+  const size_t m_capacity;                ///< Maximum number of items
+  bool m_closed;                          ///< Close toggle
+  std::deque<T> m_items{};                ///< Queued items
+  mutable std::mutex m_mutex{};           ///< Queue lock
+  std::condition_variable m_not_full{};   ///< Producers condition
+  std::condition_variable m_not_empty{};  ///< Consumers condition
+};
+
+#endif  // POOL_HPP
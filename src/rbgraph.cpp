@@ -2,7 +2,158 @@
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/copy.hpp>
 #include <boost/graph/graph_utility.hpp>
-#include <fstream>
+#include "matrix.hpp"
+
+//=============================================================================
+// Auxiliary structs and classes
+
+MaximalCharacters::MaximalCharacters() : m_characters{} {}
+
+MaximalCharacters::MaximalCharacters(const RBGraph& g) : m_characters{} {
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    if (!is_inactive(*v, g) || out_degree(*v, g) == 0) continue;
+    // for each inactive character vertex
+
+    Character c;
+    c.name = g[*v].name;
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
+    for (; e != e_end; ++e) {
+      c.species.push_back(g[target(*e, g)].name);
+    }
+
+    std::sort(c.species.begin(), c.species.end());
+
+    m_characters.push_back(c);
+  }
+
+  for (auto& c : m_characters) {
+    c.maximal = !is_dominated(c);
+  }
+}
+
+std::list<std::string> MaximalCharacters::update(
+    const std::list<std::string>& changed, const RBGraph& g) {
+  std::list<std::string> output;
+
+  // species sets (old and new) of the changed characters
+  std::list<std::vector<std::string>> changed_species;
+
+  for (const auto& name : changed) {
+    auto c = std::find_if(
+        m_characters.begin(), m_characters.end(),
+        [&name](const Character& i) { return i.name == name; });
+
+    if (c != m_characters.end()) changed_species.push_back(c->species);
+
+    const auto v = vertex_map(g).find(name);
+
+    if (v == vertex_map(g).cend() || !is_inactive(v->second, g) ||
+        out_degree(v->second, g) == 0) {
+      // name is not an inactive character of g anymore
+      if (c != m_characters.end()) m_characters.erase(c);
+
+      continue;
+    }
+
+    if (c == m_characters.end()) {
+      // name is a new inactive character of g
+      m_characters.push_back({name, {}, false});
+      c = std::prev(m_characters.end());
+    }
+
+    c->species.clear();
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(v->second, g);
+    for (; e != e_end; ++e) {
+      c->species.push_back(g[target(*e, g)].name);
+    }
+
+    std::sort(c->species.begin(), c->species.end());
+
+    changed_species.push_back(c->species);
+  }
+
+  for (auto& c : m_characters) {
+    bool affected = false;
+
+    for (const auto& species : changed_species) {
+      if (std::includes(species.cbegin(), species.cend(), c.species.cbegin(),
+                        c.species.cend())) {
+        // c may be included in (or include) a changed character
+        affected = true;
+
+        break;
+      }
+    }
+
+    if (!affected) continue;
+
+    const auto maximal = !is_dominated(c);
+
+    if (maximal && !c.maximal) output.push_back(c.name);
+
+    c.maximal = maximal;
+  }
+
+  return output;
+}
+
+void MaximalCharacters::prune(const RBGraph& g) {
+  m_characters.remove_if([&g](const Character& c) {
+    return vertex_map(g).find(c.name) == vertex_map(g).cend();
+  });
+}
+
+std::list<RBVertex> MaximalCharacters::characters(const RBGraph& g) const {
+  std::list<RBVertex> output;
+
+  for (const auto& c : m_characters) {
+    if (!c.maximal) continue;
+
+    const auto v = vertex_map(g).find(c.name);
+
+    if (v != vertex_map(g).cend()) output.push_back(v->second);
+  }
+
+  return output;
+}
+
+bool MaximalCharacters::is_maximal(const std::string& name) const {
+  for (const auto& c : m_characters) {
+    if (c.name == name) return c.maximal;
+  }
+
+  return false;
+}
+
+bool MaximalCharacters::is_dominated(const Character& c) const {
+  bool before_c = true;
+
+  for (const auto& i : m_characters) {
+    if (&i == &c) {
+      before_c = false;
+
+      continue;
+    }
+
+    if (i.species.size() < c.species.size() ||
+        !std::includes(i.species.cbegin(), i.species.cend(),
+                       c.species.cbegin(), c.species.cend()))
+      // i doesn't include c
+      continue;
+
+    if (i.species.size() > c.species.size() || before_c)
+      // i strictly includes c, or it has the same species and comes first
+      return true;
+  }
+
+  return false;
+}
 
 //=============================================================================
 // Boost functions (overloading)
@@ -35,19 +186,18 @@ void remove_vertex(const std::string& name, RBGraph& g) {
 }
 
 RBVertex add_vertex(const std::string& name, const Type type, RBGraph& g) {
-  try {
+  const auto it = vertex_map(g).lower_bound(name);
+
+  if (it != vertex_map(g).end() && it->first == name) {
     // if a vertex with the same name already exists
-    const auto u = vertex_map(g).at(name);
     // return its descriptor and do nothing
-    return u;
-  } catch (const std::out_of_range& e) {
-    // continue with the algorithm
+    return it->second;
   }
 
   const auto v = boost::add_vertex(g);
 
   // insert v in the map
-  vertex_map(g)[name] = v;
+  vertex_map(g).emplace_hint(it, name, v);
 
   g[v].name = name;
   g[v].type = type;
@@ -101,6 +251,8 @@ void copy_graph(const RBGraph& g, RBGraph& g_copy) {
   num_species(g_copy) = num_species(g);
   num_characters(g_copy) = num_characters(g);
 
+  g_copy[boost::graph_bundle].duplicates = g[boost::graph_bundle].duplicates;
+
   // rebuild g_copy's map
   build_vertex_map(g_copy);
 }
@@ -125,10 +277,91 @@ void copy_graph(const RBGraph& g, RBGraph& g_copy, RBVertexMap& v_map) {
   num_species(g_copy) = num_species(g);
   num_characters(g_copy) = num_characters(g);
 
+  g_copy[boost::graph_bundle].duplicates = g[boost::graph_bundle].duplicates;
+
   // rebuild g_copy's map
   build_vertex_map(g_copy);
 }
 
+std::string fingerprint(const RBGraph& g) {
+  std::vector<std::string> entries;
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    // characters are described by the species they are connected to
+    if (is_character(*v, g) && out_degree(*v, g) > 0) continue;
+
+    std::vector<std::string> adj;
+
+    RBOutEdgeIter e, e_end;
+    std::tie(e, e_end) = out_edges(*v, g);
+    for (; e != e_end; ++e) {
+      // '=' for red edges, '-' for black edges
+      adj.push_back((is_red(*e, g) ? "=" : "-") + g[target(*e, g)].name);
+    }
+
+    std::sort(adj.begin(), adj.end());
+
+    std::string entry = g[*v].name + ":";
+    for (const auto& kk : adj) {
+      entry += kk;
+    }
+
+    entries.push_back(entry);
+  }
+
+  std::sort(entries.begin(), entries.end());
+
+  std::string output;
+  for (const auto& kk : entries) {
+    output += kk + ";";
+  }
+
+  return output;
+}
+
+size_t graph_bytes(const RBGraph& g) {
+  // list nodes carry two pointers, map nodes four (with the color)
+  const size_t list_node = 2 * sizeof(void*);
+  const size_t map_node = 4 * sizeof(void*);
+
+  size_t output = sizeof(RBGraph);
+
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(g);
+  for (; v != v_end; ++v) {
+    // vertex (with the head of its out edge list), with its name stored twice:
+    // in the vertex and in the vertex map
+    output += list_node + sizeof(RBVertexProperties) + list_node;
+    output += map_node + sizeof(RBVertexNameMap::value_type);
+    output += 2 * g[*v].name.capacity();
+  }
+
+  // edge, plus its entries in the out edge lists of both ends
+  const size_t edge =
+      list_node + sizeof(RBEdgeProperties) + 2 * (list_node + list_node);
+
+  output += num_edges(g) * edge;
+
+  return output;
+}
+
+std::list<std::string> species_names(const RBVertex v, const RBGraph& g) {
+  std::list<std::string> output{g[v].name};
+
+  const auto& duplicates = g[boost::graph_bundle].duplicates;
+
+  if (!duplicates) return output;
+
+  const auto names = duplicates->find(g[v].name);
+
+  if (names != duplicates->cend())
+    output.insert(output.cend(), names->second.cbegin(), names->second.cend());
+
+  return output;
+}
+
 std::ostream& operator<<(std::ostream& os, const RBGraph& g) {
   std::list<std::string> lines;
   std::list<std::string> species;
@@ -218,10 +451,7 @@ std::ostream& operator<<(std::ostream& os, const RBGraph& g) {
 // File I/O
 
 void read_graph(const std::string& filename, RBGraph& g) {
-  std::vector<RBVertex> species, characters;
-  bool first_line = true;
-  std::string line;
-  std::ifstream file(filename);
+  const MappedFile file(filename);
 
   if (!file) {
     // input file doesn't exist
@@ -229,100 +459,18 @@ void read_graph(const std::string& filename, RBGraph& g) {
         "Failed to read graph from file: no such file or directory");
   }
 
-  size_t index = 0;
-  while (std::getline(file, line)) {
-    // for each line in file
-    std::istringstream iss(line);
-
-    if (first_line) {
-      // read rows and columns (species and characters)
-      size_t num_s, num_c;
-
-      iss >> num_s;
-      iss >> num_c;
-
-      species.resize(num_s);
-      characters.resize(num_c);
-
-      if (species.size() == 0 || characters.size() == 0) {
-        // input file parsing error
-        throw std::runtime_error(
-            "Failed to read graph from file: badly formatted line 0");
-      }
-
-      // insert species in the graph
-      for (size_t j = 0; j < species.size(); ++j) {
-        const auto v_name = "s" + std::to_string(j);
-
-        species[j] = add_vertex(v_name, Type::species, g);
-      }
-
-      // insert characters in the graph
-      for (size_t j = 0; j < characters.size(); ++j) {
-        const auto v_name = "c" + std::to_string(j);
-
-        characters[j] = add_vertex(v_name, Type::character, g);
-      }
-
-      first_line = false;
-    } else {
-      char value;
-
-      // read binary matrix
-      while (iss >> value) {
-        bool red_edge = false;
-
-        switch (value) {
-#ifdef DEBUG
-          case '2':
-            // permit red edges from input matrix only if debugging
-            red_edge = true;
-#endif
-
-          case '1':
-            // add edge between species[s_index] and characters[c_index]
-            {
-              const auto s_index = index / characters.size(),
-                         c_index = index % characters.size();
-
-              if (s_index >= species.size() || c_index >= characters.size()) {
-                // input file parsing error
-                throw std::runtime_error(
-                    "Failed to read graph from file: oversized matrix");
-              }
-
-              RBEdge edge;
-              std::tie(edge, std::ignore) =
-                  add_edge(species[s_index], characters[c_index], g);
-
-              if (red_edge) g[edge].color = Color::red;
-            }
-            break;
-
-          case '0':
-            // ignore
-            break;
-
-          default:
-            // input file parsing error
-            throw std::runtime_error(
-                "Failed to read graph from file: unexpected value in matrix");
-        }
-
-        index++;
-      }
-    }
-  }
+  load_graph(file.data(), file.size(), g);
+}
 
-  if (index != species.size() * characters.size()) {
-    // input file parsing error
-    throw std::runtime_error(
-        "Failed to read graph from file: undersized matrix");
-  }
+void load_graph(const char* data, const size_t size, RBGraph& g) {
+  Matrix m;
+  SparseMatrix sparse;
 
-  if (species.size() == 0 || characters.size() == 0) {
-    // input file parsing error
-    throw std::runtime_error("Failed to read graph from file: empty file");
+  if (load_matrix(data, size, m, sparse, collapse::enabled)) {
+    // the graph is built from the edges, without expanding the matrix
+    build_graph(sparse, g);
+  } else {
+    build_graph(m, g);
   }
 }
 
@@ -494,6 +642,9 @@ RBGraphVector connected_components(const RBGraph& g, const RBVertexIMap& c_map,
   // initialize subgraph components
   for (size_t i = 0; i < c_count; ++i) {
     components[i] = std::make_unique<RBGraph>();
+
+    (*components[i])[boost::graph_bundle].duplicates =
+        g[boost::graph_bundle].duplicates;
   }
 
   if (c_count <= 1)
@@ -502,31 +653,33 @@ RBGraphVector connected_components(const RBGraph& g, const RBVertexIMap& c_map,
 
   // graph is disconnected
 
+  // vertices are visited in the order of g, not in the (address) order of
+  // c_map, so the components don't depend on where g was allocated
+
   // add vertices to their respective subgraph
-  for (const auto& vcomp : c_map) {
+  RBVertexIter v, v_end;
+  std::tie(v, v_end) = boost::vertices(g);
+  for (; v != v_end; ++v) {
     // for each vertex
-    const auto v = vcomp.first;
-    const auto comp = vcomp.second;
+    const auto comp = c_map.at(*v);
     auto* const component = components[comp].get();
 
     // add the vertex to *component and copy its descriptor in vertices[v]
-    vertices[v] = add_vertex(g[v].name, g[v].type, *component);
+    vertices[*v] = add_vertex(g[*v].name, g[*v].type, *component);
   }
 
   // add edges to their respective vertices and subgraph
-  for (const auto& vcomp : c_map) {
-    // for each vertex
-    const auto v = vcomp.first;
-
+  std::tie(v, v_end) = boost::vertices(g);
+  for (; v != v_end; ++v) {
     // prevent duplicate edges from characters to species
-    if (!is_species(v, g)) continue;
+    if (!is_species(*v, g)) continue;
 
-    const auto new_v = vertices[v];
-    const auto comp = vcomp.second;
+    const auto new_v = vertices[*v];
+    const auto comp = c_map.at(*v);
     auto* const component = components[comp].get();
 
     RBOutEdgeIter e, e_end;
-    std::tie(e, e_end) = out_edges(v, g);
+    std::tie(e, e_end) = out_edges(*v, g);
     for (; e != e_end; ++e) {
       // for each out edge
       const auto new_vt = vertices[target(*e, g)];
@@ -671,22 +824,31 @@ const std::list<RBVertex> maximal_characters(const RBGraph& g) {
 }
 
 RBGraph maximal_reducible_graph(const RBGraph& g, const bool active) {
+  return maximal_reducible_graph(g, maximal_characters(g), active);
+}
+
+RBGraph maximal_reducible_graph(const RBGraph& g, const std::list<RBVertex>& cm,
+                                const bool active) {
   // copy g to gm
   RBGraph gm;
-  copy_graph(g, gm);
+  RBVertexMap v_map;
+  copy_graph(g, gm, v_map);
 
-  // compute the maximal characters of gm
-  const auto cm = maximal_characters(gm);
+  // the maximal characters of gm
+  std::list<RBVertex> cm_gm;
+  for (const auto& v : cm) {
+    cm_gm.push_back(v_map.at(v));
+  }
 
   if (logging::enabled) {
     // verbosity enabled
     std::cout << "Maximal characters Cm = { ";
 
-    for (const auto& kk : cm) {
+    for (const auto& kk : cm_gm) {
       std::cout << gm[kk].name << " ";
     }
 
-    std::cout << "} - Count: " << cm.size() << std::endl;
+    std::cout << "} - Count: " << cm_gm.size() << std::endl;
   }
 
   // remove non-maximal characters of gm
@@ -703,7 +865,7 @@ RBGraph maximal_reducible_graph(const RBGraph& g, const bool active) {
       // don't remove active or non-character vertices
       continue;
 
-    remove_vertex_if(*v, if_not_maximal(cm), gm);
+    remove_vertex_if(*v, if_not_maximal(cm_gm), gm);
   }
 
   remove_singletons(gm);
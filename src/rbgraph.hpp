@@ -3,6 +3,7 @@
 
 #include <boost/graph/adjacency_list.hpp>
 #include <iostream>
+#include <memory>
 #include "globals.hpp"
 
 //=============================================================================
@@ -22,6 +23,12 @@ typedef boost::adjacency_list_traits<boost::listS,       // OutEdgeList
 */
 typedef std::map<std::string, RBTraits::vertex_descriptor> RBVertexNameMap;
 
+/**
+  Map of species names and the names of the species with the same characters
+  collapsed into them (red-black graph)
+*/
+typedef std::map<std::string, std::list<std::string>> RBDuplicateMap;
+
 //=============================================================================
 // Data structures
 
@@ -78,6 +85,10 @@ struct RBGraphProperties {
 
   RBVertexNameMap vertex_map{};  ///< Map for vertex names and vertices in the
                                  ///< graph
+
+  std::shared_ptr<const RBDuplicateMap> duplicates{};  ///< Collapsed species,
+                                                       ///< if any (shared by
+                                                       ///< the copies)
 };
 
 //=============================================================================
@@ -206,6 +217,98 @@ struct if_not_maximal {
   const std::list<RBVertex>* const m_cm{};
 };
 
+/**
+  @brief Maximal characters of a red-black graph, maintained across
+         realizations
+
+  Characters are tracked by name, together with their set of species, so the
+  same object can follow a graph through copies and connected components.
+  Only inactive characters are tracked, as in \e maximal_characters: when two
+  characters have the same set of species, the first one (in vertex order) is
+  the maximal one.
+*/
+class MaximalCharacters {
+ public:
+  /**
+    @brief Default constructor, with no characters
+  */
+  MaximalCharacters();
+
+  /**
+    @brief Constructor, classifying every inactive character of \e g
+
+    @param[in] g Red-black graph
+  */
+  MaximalCharacters(const RBGraph& g);
+
+  /**
+    @brief Reclassify the characters affected by a change of the \e changed
+           characters in \e g
+
+    The species of each changed character are read again from \e g; a changed
+    character that is no longer an inactive character of \e g stops being
+    tracked.
+    Only the characters whose species are included in the old or new species
+    of a changed character are reclassified.
+
+    @param[in] changed Names of the characters whose species changed
+    @param[in] g       Red-black graph
+
+    @return Names of the characters that became maximal
+  */
+  std::list<std::string> update(const std::list<std::string>& changed,
+                                const RBGraph& g);
+
+  /**
+    @brief Stop tracking the characters that are not in \e g
+
+    Used when \e g is a subgraph of the graph the characters were classified
+    on, e.g. its maximal reducible graph.
+
+    @param[in] g Red-black graph
+  */
+  void prune(const RBGraph& g);
+
+  /**
+    @brief Return the maximal characters that are in \e g
+
+    @param[in] g Red-black graph
+
+    @return Maximal characters (vertices) of \e g
+  */
+  std::list<RBVertex> characters(const RBGraph& g) const;
+
+  /**
+    @brief Check if the character \e name is maximal
+
+    @param[in] name Character name
+
+    @return True if \e name is a maximal character
+  */
+  bool is_maximal(const std::string& name) const;
+
+ private:
+  /**
+    @brief Struct used to represent a tracked character
+  */
+  struct Character {
+    std::string name{};                  ///< Character name
+    std::vector<std::string> species{};  ///< Sorted species names, S(c)
+    bool maximal = false;                ///< True if the character is maximal
+  };
+
+  /**
+    @brief Check if \e c is included in another tracked character
+
+    @param[in] c Tracked character
+
+    @return True if \e c is not maximal
+  */
+  bool is_dominated(const Character& c) const;
+
+  std::list<Character> m_characters{};
+};
+
 //=============================================================================
 // Boost functions (overloading)
 
@@ -348,7 +451,7 @@ inline RBVertexNameMap& vertex_map(RBGraph& g) {
 
   @return Constant map in \e g
 */
-inline const RBVertexNameMap vertex_map(const RBGraph& g) {
+inline const RBVertexNameMap& vertex_map(const RBGraph& g) {
   return g[boost::graph_bundle].vertex_map;
 }
 
@@ -414,16 +517,70 @@ void copy_graph(const RBGraph& g, RBGraph& g_copy, RBVertexMap& v_map);
 */
 std::ostream& operator<<(std::ostream& os, const RBGraph& g);
 
+/**
+  @brief Return the canonical fingerprint of \e g
+
+  The fingerprint lists every species with its characters and the colors of
+  its edges, sorted by name: two graphs have the same fingerprint if and only
+  if they have the same species, characters and edges, independently of the
+  order of their vertices.
+
+  @param[in] g Red-black graph
+
+  @return Fingerprint of \e g
+*/
+std::string fingerprint(const RBGraph& g);
+
+/**
+  @brief Return an estimate of the bytes held by \e g
+
+  The estimate counts the vertices (with their names and their entries in the
+  vertex map) and the edges (with their entries in the adjacency lists).
+
+  @param[in] g Red-black graph
+
+  @return Estimated size of \e g, in bytes
+*/
+size_t graph_bytes(const RBGraph& g);
+
+/**
+  @brief Return the names of the species \e v and of the species with the
+         same characters collapsed into it when \e g was read
+
+  @param[in] v Species
+  @param[in] g Red-black graph
+
+  @return Names of the species, the one of \e v first
+*/
+std::list<std::string> species_names(const RBVertex v, const RBGraph& g);
+
 // File I/O
 
 /**
-  @brief Read from \e filename into \e g
+  @brief Read from \e filename into \e g, in the text, packed or sparse
+         format (gzip-compressed or not)
+
+  The species with the same characters are collapsed into one if
+  collapse::enabled is true.
 
   @param[in]  filename Filename
   @param[out] g        Red-black graph
 */
 void read_graph(const std::string& filename, RBGraph& g);
 
+/**
+  @brief Load the \e size bytes at \e data into \e g, in the text, packed or
+         sparse format (gzip-compressed or not)
+
+  The species with the same characters are collapsed into one if
+  collapse::enabled is true.
+
+  @param[in]  data Contents of a file
+  @param[in]  size Size of the contents, in bytes
+  @param[out] g    Red-black graph
+*/
+void load_graph(const char* data, const size_t size, RBGraph& g);
+
 //=============================================================================
 // Algorithm functions
 
@@ -641,6 +798,20 @@ const std::list<RBVertex> maximal_characters(const RBGraph& g);
 */
 RBGraph maximal_reducible_graph(const RBGraph& g, const bool active = false);
 
+/**
+  @brief Build the maximal reducible red-black graph of \e gm, given the
+         maximal characters \e cm of \e g
+
+  @param[in] g      Red-black graph
+  @param[in] cm     Maximal characters (vertices) of \e g
+  @param[in] active True: keep all active characters from \e g (GRB|CM∪A);
+                    False: ignore all active characters from \e g (GRB|CM).
+
+  @return Maximal reducible graph
+*/
+RBGraph maximal_reducible_graph(const RBGraph& g, const std::list<RBVertex>& cm,
+                                const bool active = false);
+
 /**
   @brief Check if \e g contains a red Σ-graph
 
@@ -0,0 +1,204 @@
+#include "shard.hpp"
+#include <sys/mman.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <new>
+
+namespace {
+/**
+  @brief Return the bytes of an item of a ShardQueue, aligned to \e align
+
+  @param[in] header   Size of the header of the item
+  @param[in] depth    Maximum length of a path
+  @param[in] capacity Maximum length of an outcome
+  @param[in] align    Alignment of the header
+
+  @return Size of the item, in bytes
+*/
+size_t item_bytes(const size_t header, const size_t depth,
+                  const size_t capacity, const size_t align) {
+  const size_t bytes = header + depth * sizeof(uint32_t) + capacity;
+
+  return (bytes + align - 1) / align * align;
+}
+
+/**
+  @brief Return the maximum length of the paths in \e paths
+
+  @param[in] paths Branch paths
+
+  @return Maximum length
+*/
+size_t max_length(const std::vector<std::vector<uint32_t>>& paths) {
+  size_t output = 0;
+
+  for (const auto& path : paths) {
+    output = std::max(output, path.size());
+  }
+
+  return output;
+}
+}  // namespace
+
+//=============================================================================
+// Auxiliary structs and classes
+
+SharedMemory::SharedMemory(const size_t bytes)
+    : m_data(nullptr), m_size(std::max<size_t>(bytes, 1)) {
+  m_data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+  if (m_data == MAP_FAILED) throw std::bad_alloc();
+}
+
+SharedMemory::~SharedMemory() { munmap(m_data, m_size); }
+
+SharedHashSet::SharedHashSet(const size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1)),
+      m_memory(m_capacity * sizeof(Slot)),
+      m_slots(static_cast<Slot*>(m_memory.data())) {
+  for (size_t i = 0; i < m_capacity; ++i) {
+    new (&m_slots[i].first) std::atomic<uint64_t>(0);
+    new (&m_slots[i].second) std::atomic<uint64_t>(0);
+  }
+}
+
+SharedHashSet::Key SharedHashSet::key(const std::string& text) {
+  // FNV-1a, independent of std::hash
+  uint64_t second = 14695981039346656037ull;
+
+  for (const auto c : text) {
+    second = (second ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+  }
+
+  return Key(std::hash<std::string>()(text), second);
+}
+
+void SharedHashSet::insert(const Key& key) {
+  // 0 marks the empty slots
+  const uint64_t first = (key.first == 0 ? 1 : key.first);
+  const uint64_t second = (key.second == 0 ? 1 : key.second);
+
+  for (size_t i = 0, j = slot(first); i < m_capacity; ++i) {
+    uint64_t expected = 0;
+
+    if (m_slots[j].first.compare_exchange_strong(expected, first)) {
+      m_slots[j].second = second;
+
+      return;
+    }
+
+    if (expected == first && m_slots[j].second == second) return;
+
+    j = (j + 1) % m_capacity;
+  }
+}
+
+bool SharedHashSet::contains(const Key& key) const {
+  const uint64_t first = (key.first == 0 ? 1 : key.first);
+  const uint64_t second = (key.second == 0 ? 1 : key.second);
+
+  for (size_t i = 0, j = slot(first); i < m_capacity; ++i) {
+    const uint64_t current = m_slots[j].first;
+
+    if (current == 0) return false;
+
+    // a slot whose second hash isn't written yet doesn't match
+    if (current == first && m_slots[j].second == second) return true;
+
+    j = (j + 1) % m_capacity;
+  }
+
+  return false;
+}
+
+size_t SharedHashSet::slot(const uint64_t hash) const {
+  return hash % m_capacity;
+}
+
+ShardQueue::ShardQueue(const std::vector<std::vector<uint32_t>>& paths,
+                       const size_t capacity)
+    : m_size(paths.size()),
+      m_depth(max_length(paths)),
+      m_capacity(capacity),
+      m_stride(item_bytes(sizeof(Item), m_depth, m_capacity, alignof(Item))),
+      m_memory(m_size * m_stride) {
+  for (size_t i = 0; i < m_size; ++i) {
+    auto* header = new (item(i)) Item();
+    header->state = pending;
+    header->worker = 0;
+    header->length = paths[i].size();
+    header->outcome = 0;
+
+    std::copy(paths[i].cbegin(), paths[i].cend(),
+              reinterpret_cast<uint32_t*>(header + 1));
+  }
+}
+
+bool ShardQueue::pop(const pid_t worker, size_t& index) {
+  for (size_t i = 0; i < m_size; ++i) {
+    uint32_t expected = pending;
+
+    if (!item(i)->state.compare_exchange_strong(expected, taken)) continue;
+
+    item(i)->worker = worker;
+    index = i;
+
+    return true;
+  }
+
+  return false;
+}
+
+void ShardQueue::publish(const size_t index, const std::string& outcome) {
+  auto* header = item(index);
+  auto* data = reinterpret_cast<char*>(reinterpret_cast<uint32_t*>(header + 1) +
+                                       m_depth);
+
+  header->outcome = std::min(outcome.size(), m_capacity);
+  std::memcpy(data, outcome.data(), header->outcome);
+
+  // the outcome is written before the item is marked as done
+  header->state = done;
+}
+
+std::vector<size_t> ShardQueue::taken_by(const pid_t worker) const {
+  std::vector<size_t> output;
+
+  for (size_t i = 0; i < m_size; ++i) {
+    if (item(i)->state == taken && item(i)->worker == worker)
+      output.push_back(i);
+  }
+
+  return output;
+}
+
+void ShardQueue::requeue(const size_t index) {
+  item(index)->worker = 0;
+  item(index)->state = pending;
+}
+
+ShardQueue::State ShardQueue::state(const size_t index) const {
+  return static_cast<State>(item(index)->state.load());
+}
+
+std::vector<uint32_t> ShardQueue::path(const size_t index) const {
+  const auto* header = item(index);
+  const auto* data = reinterpret_cast<const uint32_t*>(header + 1);
+
+  return std::vector<uint32_t>(data, data + header->length);
+}
+
+std::string ShardQueue::outcome(const size_t index) const {
+  const auto* header = item(index);
+  const auto* data = reinterpret_cast<const char*>(
+      reinterpret_cast<const uint32_t*>(header + 1) + m_depth);
+
+  return std::string(data, header->outcome);
+}
+
+ShardQueue::Item* ShardQueue::item(const size_t index) const {
+  return reinterpret_cast<Item*>(static_cast<char*>(m_memory.data()) +
+                                 index * m_stride);
+}
@@ -0,0 +1,246 @@
+#ifndef SHARD_HPP
+#define SHARD_HPP
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+// Auxiliary structs and classes
+
+/**
+  @brief Block of memory shared by a process and its children
+
+  The block is an anonymous shared mapping: the children created by fork()
+  after its construction see the same memory as their parent.
+*/
+class SharedMemory {
+ public:
+  /**
+    @brief Constructor, mapping \e bytes of zeroed memory
+
+    @param[in] bytes Size of the block
+  */
+  SharedMemory(const size_t bytes);
+
+  /**
+    @brief Destructor, unmapping the memory
+  */
+  ~SharedMemory();
+
+  SharedMemory(const SharedMemory&) = delete;
+  SharedMemory& operator=(const SharedMemory&) = delete;
+
+  /**
+    @brief Return the first byte of the block
+
+    @return Pointer to the block
+  */
+  void* data() const { return m_data; }
+
+ private:
+  void* m_data;   ///< Mapped memory
+  size_t m_size;  ///< Size of the mapped memory
+};
+
+/**
+  @brief Set of strings shared by the processes of a sharded search
+
+  Lock-free open addressing table: every string is stored as two independent
+  64-bit hashes, so a string is reported in the set only if both of its
+  hashes match (a false positive has a probability of about 2^-128).
+  Strings are only added, and the insertions that find the table full, or
+  that race with the insertion of a string with the same first hash, are
+  dropped: a string missing from the set is only a lost hint.
+*/
+class SharedHashSet {
+ public:
+  /**
+    @brief Key of a string in the set: two independent 64-bit hashes
+  */
+  typedef std::pair<uint64_t, uint64_t> Key;
+
+  /**
+    @brief Constructor, allocating room for \e capacity keys
+
+    @param[in] capacity Number of keys
+  */
+  SharedHashSet(const size_t capacity);
+
+  /**
+    @brief Return the key of \e text
+
+    @param[in] text String
+
+    @return Key
+  */
+  static Key key(const std::string& text);
+
+  /**
+    @brief Add \e key to the set
+
+    @param[in] key Key
+  */
+  void insert(const Key& key);
+
+  /**
+    @brief Check if \e key is in the set
+
+    @param[in] key Key
+
+    @return True if \e key is in the set
+  */
+  bool contains(const Key& key) const;
+
+ private:
+  /**
+    @brief Slot of the table (0 = empty)
+  */
+  struct Slot {
+    std::atomic<uint64_t> first;   ///< First hash, set first
+    std::atomic<uint64_t> second;  ///< Second hash, set after the first
+  };
+
+  /**
+    @brief Return the slot of the table where \e hash is searched first
+
+    @param[in] hash First hash of a key
+
+    @return Slot index
+  */
+  size_t slot(const uint64_t hash) const;
+
+  size_t m_capacity;      ///< Number of slots
+  SharedMemory m_memory;  ///< Slots
+  Slot* m_slots;          ///< Keys
+};
+
+/**
+  @brief Work queue of branch paths shared by the processes of a sharded
+         search
+
+  Every item is a branch path (the indices of the safe sources chosen from the
+  root of the search), taken by one worker process at a time, which publishes
+  the outcome of the branch as a string.
+  The items taken by a worker that crashed can be queued again.
+*/
+class ShardQueue {
+ public:
+  /**
+    @brief Item states
+  */
+  enum State : uint32_t {
+    pending,  ///< Not taken yet
+    taken,    ///< Taken by a worker
+    done      ///< Outcome published
+  };
+
+  /**
+    @brief Constructor
+
+    @param[in] paths    Branch paths
+    @param[in] capacity Maximum length of an outcome
+  */
+  ShardQueue(const std::vector<std::vector<uint32_t>>& paths,
+             const size_t capacity);
+
+  /**
+    @brief Take the first pending item
+
+    @param[in]  worker Process id of the worker
+    @param[out] index  Index of the item
+
+    @return True if an item was taken
+  */
+  bool pop(const pid_t worker, size_t& index);
+
+  /**
+    @brief Publish the outcome of the item \e index
+
+    @param[in] index   Index of the item
+    @param[in] outcome Outcome (truncated to the capacity of the queue)
+  */
+  void publish(const size_t index, const std::string& outcome);
+
+  /**
+    @brief Return the items taken by \e worker and not published
+
+    @param[in] worker Process id of the worker
+
+    @return Indices of the items
+  */
+  std::vector<size_t> taken_by(const pid_t worker) const;
+
+  /**
+    @brief Queue again the item \e index, taken by a worker that exited
+           before publishing its outcome
+
+    @param[in] index Index of the item
+  */
+  void requeue(const size_t index);
+
+  /**
+    @brief Return the number of items
+
+    @return Number of items
+  */
+  size_t size() const { return m_size; }
+
+  /**
+    @brief Return the state of the item \e index
+
+    @param[in] index Index of the item
+
+    @return State of the item
+  */
+  State state(const size_t index) const;
+
+  /**
+    @brief Return the branch path of the item \e index
+
+    @param[in] index Index of the item
+
+    @return Branch path
+  */
+  std::vector<uint32_t> path(const size_t index) const;
+
+  /**
+    @brief Return the outcome of the item \e index
+
+    @param[in] index Index of the item, which must be done
+
+    @return Outcome
+  */
+  std::string outcome(const size_t index) const;
+
+ private:
+  /**
+    @brief Header of an item, followed by its path and its outcome
+  */
+  struct Item {
+    std::atomic<uint32_t> state;  ///< Item state
+    std::atomic<pid_t> worker;    ///< Worker that took the item
+    uint32_t length;              ///< Length of the path
+    uint32_t outcome;             ///< Length of the outcome
+  };
+
+  /**
+    @brief Return the header of the item \e index
+
+    @param[in] index Index of the item
+
+    @return Pointer to the item
+  */
+  Item* item(const size_t index) const;
+
+  size_t m_size;          ///< Number of items
+  size_t m_depth;         ///< Maximum length of a path
+  size_t m_capacity;      ///< Maximum length of an outcome
+  size_t m_stride;        ///< Bytes of an item
+  SharedMemory m_memory;  ///< Items
+};
+
+#endif  // SHARD_HPP
@@ -0,0 +1,62 @@
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g1, g2, g3;
+  TranspositionTable table;
+
+  // without a limit, the budget is never exceeded
+  {
+    const MemoryReservation reservation(1 << 20);
+
+    assert(memory_budget().used() == 1 << 20);
+    assert(!memory_budget().exceeded());
+  }
+
+  assert(memory_budget().used() == 0);
+  assert(memory_budget().peak() == 1 << 20);
+
+  read_graph("tests/test_5x2.txt", g1);
+  assert(graph_bytes(g1) > sizeof(RBGraph));
+
+  // the oldest entries of the table are evicted to stay within the limit
+  memory::limit = 1024;
+
+  for (size_t i = 0; i < 100; ++i) {
+    table.insert(std::to_string(i), std::make_pair(
+                                        std::list<SignedCharacter>{}, false));
+  }
+
+  std::pair<std::list<SignedCharacter>, bool> result;
+
+  assert(table.size() < 100);
+  assert(memory_budget().evictions == 100 - table.size());
+  assert(!memory_budget().exceeded());
+  assert(!table.find("0", result));
+  assert(table.find("99", result));
+
+  table.clear();
+
+  assert(memory_budget().used() == 0);
+
+  // the reductions don't change over the memory budget
+  memory::limit = 1;
+  exponential::enabled = true;
+
+  read_graph("tests/test_5x2.txt", g2);
+  const auto count = count_reductions(g2);
+
+  assert(count.first == 2);
+  assert(count.second == 0);
+
+  read_graph("tests/test_5x2.txt", g3);
+  const auto output = try_reduce(g3);
+
+  assert(output.second);
+  assert(output.first.size() == 3);
+  assert(memory_budget().lean > 0);
+
+  std::cout << "budget: tests passed" << std::endl;
+
+  return 0;
+}
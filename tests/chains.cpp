@@ -0,0 +1,77 @@
+#include "hdgraph.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  HDGraph hasse;
+  RBGraph g;
+
+  read_graph("tests/test_6x3.txt", g);
+  RBGraph gm = maximal_reducible_graph(g);
+  hasse_diagram(hasse, g, gm);
+
+  HDChain chain;
+  size_t count = 0;
+
+  ChainEnumerator chains(hasse);
+  while (chains.next(chain)) {
+    assert(in_degree(chain.source, hasse) == 0);
+    assert(out_degree(chain.sink, hasse) == 0);
+    assert(chain.edges.size() == 1);
+    assert(source(chain.edges.front(), hasse) == chain.source);
+    assert(target(chain.edges.back(), hasse) == chain.sink);
+
+    count++;
+  }
+
+  assert(count == 6);
+  assert(!chains.next(chain));
+
+  ChainEnumerator skipped(hasse);
+  for (count = 0; skipped.next(chain); ++count) {
+    skipped.skip_source();
+  }
+
+  assert(count == 3);
+
+  ChainEnumerator partition(hasse, {source_vertices(hasse).front()});
+  for (count = 0; partition.next(chain); ++count) {
+  }
+
+  assert(count == 2);
+
+  // s0 and s1 share m, which has two paths to a sink: m is descended into
+  // once, so its chains are yielded for s0 only. s2 reaches the sink t0,
+  // already visited, with a single edge
+  typedef std::list<std::string> L;
+
+  HDGraph diamond;
+  const auto s0 = add_vertex(L{"s0"}, L{"c0"}, diamond);
+  const auto s1 = add_vertex(L{"s1"}, L{"c1"}, diamond);
+  const auto s2 = add_vertex(L{"s2"}, L{"c2"}, diamond);
+  const auto m = add_vertex(L{"m"}, L{"c0", "c1"}, diamond);
+  const auto t0 = add_vertex(L{"t0"}, L{"c0", "c1", "c2"}, diamond);
+  const auto t1 = add_vertex(L{"t1"}, L{"c0", "c1", "c3"}, diamond);
+  add_edge(s0, m, {{"c1", State::gain}}, diamond);
+  add_edge(s1, m, {{"c0", State::gain}}, diamond);
+  add_edge(m, t0, {{"c2", State::gain}}, diamond);
+  add_edge(m, t1, {{"c3", State::gain}}, diamond);
+  add_edge(s2, t0, {{"c0", State::gain}, {"c1", State::gain}}, diamond);
+
+  for (const auto v : boost::make_iterator_range(vertices(diamond))) {
+    diamond[v].expanded = true;
+  }
+
+  std::list<HDVertex> chain_sources;
+  ChainEnumerator visited(diamond, {s0, s1, s2});
+  while (visited.next(chain)) {
+    assert(out_degree(chain.sink, diamond) == 0);
+
+    chain_sources.push_back(chain.source);
+  }
+
+  assert(chain_sources == std::list<HDVertex>({s0, s0, s2}));
+
+  std::cout << "chains: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g1, g2;
+
+  // a checkpoint after every safe source
+  exponential::enabled = true;
+  checkpoint::file = "tests/checkpoint.tmp";
+  checkpoint::interval = 0;
+
+  read_graph("tests/test_5x2.txt", g1);
+  const auto output1 = try_reduce(g1);
+
+  assert(output1.second);
+  assert(checkpoint_frames().empty());
+
+  // the last checkpoint holds the choice of the input graph, completed
+  transposition_table().clear();
+  load_checkpoint(checkpoint::file);
+
+  assert(resume_frames().size() == 1);
+  assert(resume_frames().front().index == 2);
+  assert(resume_frames().front().outputs.size() == 2);
+  assert(resume_frames().front().outputs.front() == output1.first);
+
+  // the resumed search doesn't test the safe sources again
+
+  read_graph("tests/test_5x2.txt", g2);
+  const auto output2 = try_reduce(g2);
+
+  assert(output2 == output1);
+  assert(resume_frames().empty());
+  assert(transposition_table().size() == 1);
+
+  // the transposition table is saved with the choices
+  const ReductionResult result({{"c1", State::gain}, {"c1", State::lose}}, true);
+  transposition_table().insert("s0:-c1;", result);
+
+  save_checkpoint(checkpoint::file);
+  transposition_table().clear();
+  load_checkpoint(checkpoint::file);
+
+  ReductionResult found;
+
+  assert(transposition_table().find("s0:-c1;", found));
+  assert(found == result);
+
+  // a checkpoint can't be resumed on another graph
+  RBGraph g3, g4;
+  transposition_table().clear();
+  read_graph("tests/test_5x2.txt", g3);
+  try_reduce(g3);
+
+  transposition_table().clear();
+  load_checkpoint(checkpoint::file);
+
+  read_graph("tests/test_5x2.txt", g4);
+  add_vertex("s5", Type::species, g4);
+  add_edge(get_vertex("s5", g4), get_vertex("c0", g4), g4);
+
+  try {
+    try_reduce(g4);
+    assert(false);
+  } catch (const CheckpointMismatch& e) {
+  }
+
+  std::remove(checkpoint::file.c_str());
+
+  std::cout << "checkpoint: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include <cassert>
+#include <set>
+#include <sstream>
+#include "hdgraph.hpp"
+#include "matrix.hpp"
+
+/**
+  @brief Return the lists of species of the vertices of the Hasse diagram of
+         \e g
+*/
+std::set<std::list<std::string>> hasse_species(const RBGraph& g) {
+  HDGraph hasse;
+  hasse_vertices(hasse, g, g);
+
+  std::set<std::list<std::string>> output;
+
+  HDVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    output.insert(hasse[*v].species);
+  }
+
+  return output;
+}
+
+int main(int argc, const char* argv[]) {
+  // 7 rows of 70 cells, with 3 distinct rows
+  const size_t profile[] = {0, 1, 0, 2, 1, 0, 2};
+
+  std::string text = "7 70\n";
+
+  for (const auto p : profile) {
+    for (size_t c = 0; c < 70; ++c) {
+      text += ((c + p) % 3 == 0 && c % (p + 2) != 1 ? "1 " : "0 ");
+    }
+
+    text += "\n";
+  }
+
+  Matrix m1;
+  parse_matrix(text.data(), text.size(), m1);
+
+  assert(m1.species == 7 && m1.members.empty());
+
+  for (const auto simd : {Simd::none, Simd::sse2, Simd::avx2}) {
+    Matrix m2;
+    parse_matrix(text.data(), text.size(), m2, simd, true);
+
+    assert(m2.species == 3);
+    assert(m2.ones.size() == 3 * m2.words);
+    assert(m2.members == (std::vector<std::vector<size_t>>{
+                             {0, 2, 5}, {1, 4}, {3, 6}}));
+
+    for (size_t r = 0; r < 3; ++r) {
+      for (size_t c = 0; c < 70; ++c) {
+        assert(m2.at(r, c) == m1.at(m2.members[r].front(), c));
+      }
+    }
+  }
+
+  // the rows are collapsed after reading them
+  Matrix m3 = m1;
+  collapse_rows(m3);
+
+  assert(m3.species == 3);
+  assert(m3.members[1] == (std::vector<size_t>{1, 4}));
+
+  // sparse matrices
+  std::ostringstream sparse;
+  write_sparse(sparse, m1);
+
+  SparseMatrix m4;
+  parse_sparse(sparse.str().data(), sparse.str().size(), m4);
+  collapse_rows(m4);
+
+  assert(m4.species == 3 && m4.members == m3.members);
+
+  Matrix m5;
+  expand_matrix(m4, m5);
+
+  assert(m5.ones == m3.ones);
+
+  // the graph holds the distinct species, and the Hasse diagram lists all of
+  // them
+  RBGraph g1, g2, g3;
+  build_graph(m1, g1);
+  build_graph(m3, g2);
+  build_graph(m4, g3);
+
+  assert(num_species(g2) == 3);
+  assert(fingerprint(g2) == fingerprint(g3));
+  assert(species_names(get_vertex("s1", g2), g2) ==
+         (std::list<std::string>{"s1", "s4"}));
+  assert(species_names(get_vertex("s1", g1), g1) ==
+         (std::list<std::string>{"s1"}));
+
+  RBGraph g4;
+  copy_graph(g2, g4);
+
+  assert(species_names(get_vertex("s3", g4), g4) ==
+         (std::list<std::string>{"s3", "s6"}));
+
+  assert(hasse_species(g2) == hasse_species(g1));
+  assert(hasse_species(g3) == hasse_species(g1));
+
+  std::cout << "collapse: tests passed" << std::endl;
+
+  return 0;
+}
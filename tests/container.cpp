@@ -0,0 +1,65 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include "matrix.hpp"
+
+int main(int argc, const char* argv[]) {
+  const std::string file = "tests/container.tmp";
+
+  Matrix m1, m2;
+  read_matrix("tests/test_5x2.txt", m1);
+  read_matrix("tests/test_6x3.txt", m2);
+
+  {
+    std::ofstream os(file, std::ios::binary);
+    ContainerWriter writer(os);
+
+    writer.add("first", m1);
+    writer.add("second", m2);
+    writer.add("", m1);
+    writer.close();
+  }
+
+  assert(is_container(file));
+  assert(!is_container("tests/test_5x2.txt"));
+  assert(!is_container("tests/nonexistent.txt"));
+
+  const Container container(file);
+
+  assert(container.size() == 3);
+  assert(container.name(0) == "first");
+  assert(container.name(1) == "second");
+  assert(container.name(2) == "");
+
+  Matrix m;
+  container.read(1, m);
+
+  assert(m.species == 6 && m.characters == 3);
+  assert(m.ones == m2.ones);
+
+  container.read(2, m);
+
+  assert(m.species == 5 && m.characters == 2);
+  assert(m.ones == m1.ones);
+
+  // a container is not a matrix
+  try {
+    read_matrix(file, m);
+    assert(false);
+  } catch (const std::runtime_error& e) {
+  }
+
+  try {
+    const Container matrix("tests/test_5x2.txt");
+    assert(false);
+  } catch (const std::runtime_error& e) {
+    assert(std::string(e.what()) ==
+           "Failed to read container from file: not a container");
+  }
+
+  std::remove(file.c_str());
+
+  std::cout << "container: tests passed" << std::endl;
+
+  return 0;
+}
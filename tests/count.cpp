@@ -0,0 +1,63 @@
+#include <limits>
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g1, g2, g3;
+  ReductionCount count;
+
+  // every safe source is counted
+  exponential::enabled = true;
+
+  read_graph("tests/test_5x2.txt", g1);
+  count = count_reductions(g1);
+
+  assert(count.first == 2);
+  assert(count.second == 0);
+
+  read_graph("tests/test_6x3.txt", g2);
+  count = count_reductions(g2);
+
+  assert(count.first == 0);
+  assert(count.second == 0);
+
+  // c1 is active in the input graph, so losing it gives a partial reduction
+  add_vertex("s1", Type::species, g3);
+  add_vertex("c1", Type::character, g3);
+  add_edge(get_vertex("s1", g3), get_vertex("c1", g3), Color::red, g3);
+
+  count = count_reductions(g3);
+
+  assert(count.first == 0);
+  assert(count.second == 1);
+
+  // 64 components with 2 reductions each: the count stops at the largest
+  // size_t instead of wrapping around to 0
+  RBGraph g4;
+
+  for (size_t i = 0; i < 64; ++i) {
+    const auto n = std::to_string(i);
+
+    for (const auto& name : {"a" + n, "b" + n}) {
+      add_vertex("c" + name, Type::character, g4);
+    }
+
+    for (const auto& name : {"s" + n, "t" + n, "u" + n}) {
+      add_vertex(name, Type::species, g4);
+    }
+
+    add_edge(get_vertex("s" + n, g4), get_vertex("ca" + n, g4), g4);
+    add_edge(get_vertex("s" + n, g4), get_vertex("cb" + n, g4), g4);
+    add_edge(get_vertex("t" + n, g4), get_vertex("ca" + n, g4), g4);
+    add_edge(get_vertex("u" + n, g4), get_vertex("cb" + n, g4), g4);
+  }
+
+  count = count_reductions(g4);
+
+  assert(count.first == std::numeric_limits<size_t>::max());
+  assert(count.second == 0);
+
+  std::cout << "count: tests passed" << std::endl;
+
+  return 0;
+}
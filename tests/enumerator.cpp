@@ -0,0 +1,41 @@
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g1, g2;
+  std::list<SignedCharacter> reduction;
+  std::list<std::list<SignedCharacter>> reductions;
+
+  // every safe source is a branch
+  exponential::enabled = true;
+
+  read_graph("tests/test_5x2.txt", g1);
+
+  ReductionEnumerator enumerator(g1);
+  while (enumerator.next(reduction)) {
+    assert(!reduction.empty());
+    assert(!is_partial(reduction));
+
+    reductions.push_back(reduction);
+  }
+
+  assert(!enumerator.next(reduction));
+  assert(reductions.size() == count_reductions(g1).first);
+  assert(reductions.front() != reductions.back());
+
+  // the first reduction is the one returned by the exponential algorithm
+  RBGraph g3;
+  read_graph("tests/test_5x2.txt", g3);
+
+  assert(reduce(g3) == reductions.front());
+
+  read_graph("tests/test_6x3.txt", g2);
+
+  ReductionEnumerator none(g2);
+
+  assert(!none.next(reduction));
+
+  std::cout << "enumerator: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include <thread>
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g1, g2, g3;
+
+  // same graph, vertices and edges added in different orders
+  add_vertex("s1", Type::species, g1);
+  add_vertex("s2", Type::species, g1);
+  add_vertex("c1", Type::character, g1);
+  add_vertex("c2", Type::character, g1);
+  add_edge(get_vertex("s1", g1), get_vertex("c1", g1), g1);
+  add_edge(get_vertex("s2", g1), get_vertex("c2", g1), Color::red, g1);
+  add_edge(get_vertex("s2", g1), get_vertex("c1", g1), g1);
+
+  add_vertex("c2", Type::character, g2);
+  add_vertex("s2", Type::species, g2);
+  add_vertex("c1", Type::character, g2);
+  add_vertex("s1", Type::species, g2);
+  add_edge(get_vertex("s2", g2), get_vertex("c1", g2), g2);
+  add_edge(get_vertex("s2", g2), get_vertex("c2", g2), Color::red, g2);
+  add_edge(get_vertex("s1", g2), get_vertex("c1", g2), g2);
+
+  // same vertices and edges, different colors
+  copy_graph(g1, g3);
+  g3[edge(get_vertex("s2", g3), get_vertex("c2", g3), g3).first].color =
+      Color::black;
+
+  assert(fingerprint(g1) == fingerprint(g2));
+  assert(fingerprint(g1) != fingerprint(g3));
+  assert(fingerprint(RBGraph()).empty());
+
+  TranspositionTable table;
+  std::pair<std::list<SignedCharacter>, bool> result;
+
+  assert(!table.find(fingerprint(g1), result));
+
+  table.insert(fingerprint(g1), {{{"c1", State::gain}}, true});
+  table.insert(fingerprint(g3), {{}, false});
+
+  assert(table.size() == 2);
+  assert(table.find(fingerprint(g2), result));
+  assert(result.second && result.first.size() == 1);
+  assert(table.find(fingerprint(g3), result));
+  assert(!result.second && result.first.empty());
+
+  table.clear();
+
+  assert(table.size() == 0);
+
+  // every thread has its own table, unless it runs a branch of another one
+  transposition_table().insert(fingerprint(g1), {{}, true});
+
+  std::thread([&]() {
+    assert(transposition_table().size() == 0);
+
+    branch_table() = &table;
+    transposition_table().insert(fingerprint(g3), {{}, false});
+    branch_table() = nullptr;
+  }).join();
+
+  assert(transposition_table().size() == 1 && table.size() == 1);
+
+  transposition_table().clear();
+
+  std::cout << "fingerprint: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,168 @@
+#include <zlib.h>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "matrix.hpp"
+
+/**
+  @brief Write \e data in \e file, gzip-compressed as a new member (appended
+         if \e mode is "ab")
+*/
+void gzip(const std::string& file, const std::string& data,
+          const char* mode = "wb") {
+  const gzFile output = gzopen(file.c_str(), mode);
+
+  assert(output != nullptr);
+  assert(gzwrite(output, data.data(), data.size()) == int(data.size()));
+
+  gzclose(output);
+}
+
+/**
+  @brief Return the contents of \e file
+*/
+std::string contents(const std::string& file) {
+  std::ifstream input(file, std::ios::binary);
+  std::stringstream output;
+  output << input.rdbuf();
+
+  return output.str();
+}
+
+/**
+  @brief Return the error message of loading \e data, or "" if it is a
+         well-formed matrix
+*/
+std::string load_error(const std::string& data) {
+  Matrix m;
+
+  try {
+    load_matrix(data.data(), data.size(), m);
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+
+  return "";
+}
+
+int main(int argc, const char* argv[]) {
+  const std::string file = "tests/gzip.tmp";
+
+  // a text matrix of 3000 rows of 100 cells spans more than one chunk
+  std::string text = "3000 100\n";
+
+  for (size_t i = 0; i < 300000; ++i) {
+    text += ((i / 100) % 7 == 0 && (i % 100) % 3 == 0 ? '1' : '0');
+    text += (i % 100 == 99 ? '\n' : ' ');
+  }
+
+  Matrix m1, m2;
+  parse_matrix(text.data(), text.size(), m1);
+
+  gzip(file, text);
+  read_matrix(file, m2);
+
+  assert(m2.species == 3000 && m2.characters == 100);
+  assert(m2.ones == m1.ones);
+
+  const auto data = contents(file);
+
+  load_matrix(data.data(), data.size(), m2, true);
+
+  assert(m2.species == 2);
+  assert(m2.members[0].size() == 429 && m2.members[1].size() == 2571);
+
+  // the graph
+  RBGraph g1, g2;
+  gzip(file, contents("tests/test_6x3.txt"));
+  read_graph(file, g1);
+  read_graph("tests/test_6x3.txt", g2);
+
+  assert(fingerprint(g1) == fingerprint(g2));
+
+  // a first line longer than a chunk, and more than one member
+  gzip(file, "2 2 " + std::string(300000, '#') + "\n1 0\n");
+  gzip(file, "0 1\n", "ab");
+  read_matrix(file, m2);
+
+  assert(m2.species == 2 && m2.at(0, 0) == 1 && m2.at(1, 1) == 1);
+
+  // packed and sparse matrices
+  read_matrix("tests/test_6x3.txt", m1);
+
+  std::ostringstream packed, sparse;
+  pack_matrix(packed, m1);
+  write_sparse(sparse, m1);
+
+  gzip(file, packed.str());
+  read_matrix(file, m2);
+
+  assert(m2.ones == m1.ones);
+
+  gzip(file, sparse.str());
+  read_matrix(file, m2);
+
+  assert(m2.ones == m1.ones);
+
+  // the sparse matrices are loaded without being expanded
+  const auto sparse_data = contents(file);
+
+  Matrix dense;
+  SparseMatrix cells;
+
+  assert(load_matrix(sparse_data.data(), sparse_data.size(), dense, cells));
+  assert(cells.species == 6 && dense.species == 0);
+
+  RBGraph g3;
+  read_graph(file, g3);
+
+  assert(fingerprint(g3) == fingerprint(g2));
+
+  // containers
+  std::ostringstream container;
+  ContainerWriter writer(container);
+  writer.add("first", m1);
+  writer.close();
+
+  gzip(file, container.str());
+
+  assert(is_container(file));
+
+  const Container matrices(file);
+
+  assert(matrices.size() == 1 && matrices.name(0) == "first");
+
+  matrices.read(0, m2);
+
+  assert(m2.ones == m1.ones);
+
+  // errors
+  const std::string prefix = "Failed to read graph from file: ";
+
+  gzip(file, text);
+  auto bad = contents(file);
+
+  assert(load_error(bad) == "");
+  assert(load_error(bad.substr(0, bad.size() / 2)) ==
+         prefix + "truncated gzip data");
+
+  bad[bad.size() / 2] ^= 0x55;
+  bad[bad.size() / 2 + 1] ^= 0x55;
+
+  assert(load_error(bad) == prefix + "corrupted gzip data");
+
+  gzip(file, "");
+
+  assert(load_error(contents(file)) == prefix + "empty file");
+
+  gzip(file, text.substr(0, text.size() - 2));
+
+  assert(load_error(contents(file)) == prefix + "undersized matrix");
+
+  std::remove(file.c_str());
+
+  std::cout << "gzip: tests passed" << std::endl;
+
+  return 0;
+}
@@ -12,6 +12,21 @@ int main(int argc, const char* argv[]) {
   assert(num_vertices(hasse) == 3);
   assert(num_edges(hasse) == 2);
 
+  HDGraph lazy;
+  hasse_vertices(lazy, g, gm);
+
+  assert(num_vertices(lazy) == 3);
+  assert(num_edges(lazy) == 0);
+  assert(source_vertices(lazy).size() == source_vertices(hasse).size());
+
+  expand_vertex(source_vertices(lazy).front(), lazy);
+
+  assert(num_edges(lazy) == 1);
+
+  expand_vertex(source_vertices(lazy).back(), lazy);
+
+  assert(num_edges(lazy) == 2);
+
   std::cout << "hasse: tests passed" << std::endl;
 
   return 0;
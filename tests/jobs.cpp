@@ -0,0 +1,45 @@
+#include <thread>
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  const std::vector<std::string> files = {"tests/test_5x2.txt",
+                                          "tests/test_6x3.txt"};
+
+  for (const bool exponential : {false, true}) {
+    exponential::enabled = exponential;
+
+    std::vector<ReductionResult> expected;
+    for (const auto& file : files) {
+      RBGraph g;
+      read_graph(file, g);
+
+      expected.push_back(try_reduce(g));
+    }
+
+    // every file is reduced several times at the same time
+    std::vector<ReductionResult> outputs(4 * files.size());
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      threads.emplace_back([i, &files, &outputs]() {
+        RBGraph g;
+        read_graph(files[i % files.size()], g);
+
+        outputs[i] = try_reduce(g);
+      });
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      assert(outputs[i] == expected[i % files.size()]);
+    }
+  }
+
+  std::cout << "jobs: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include <cassert>
+#include <cstring>
+#include "matrix.hpp"
+
+/**
+  @brief Return the error message of parsing \e text, or "" if it is a
+         well-formed matrix
+*/
+std::string parse_error(const char* text) {
+  Matrix m;
+
+  try {
+    parse_matrix(text, std::strlen(text), m);
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+
+  return "";
+}
+
+int main(int argc, const char* argv[]) {
+  MappedFile file("tests/test_6x3.txt");
+
+  assert(file);
+  assert(file.size() > 0);
+
+  Matrix m;
+  parse_matrix(file.data(), file.size(), m);
+
+  assert(m.species == 6);
+  assert(m.characters == 3);
+  assert(m.words == 1);
+  assert(m.ones.size() == 6);
+
+  RBGraph g1, g2;
+  build_graph(m, g1);
+  read_graph("tests/test_6x3.txt", g2);
+
+  assert(num_species(g1) == 6 && num_characters(g1) == 3);
+  assert(num_edges(g1) == num_edges(g2));
+  assert(fingerprint(g1) == fingerprint(g2));
+
+  assert(!MappedFile("tests/nonexistent.txt"));
+
+  // cells are separated by any whitespace, the rest of the first line is
+  // ignored
+  assert(parse_error("2 2 comment\r\n10\r\n0 1") == "");
+  assert(parse_error("2 2\n1 0\t0\n1\n") == "");
+
+  // errors
+  const std::string prefix = "Failed to read graph from file: ";
+
+  assert(parse_error("") == prefix + "empty file");
+  assert(parse_error("\n1 0\n") == prefix + "badly formatted line 0");
+  assert(parse_error("2\n1 0\n") == prefix + "badly formatted line 0");
+  assert(parse_error("2 2\n1 0\n0 1 1\n") == prefix + "oversized matrix");
+  assert(parse_error("2 2\n1 0\n0\n") == prefix + "undersized matrix");
+  assert(parse_error("2 2\n1 0\n0 x\n") ==
+         prefix + "unexpected value in matrix");
+  assert(parse_error("9999999 9999999\n1 0\n") == prefix + "undersized matrix");
+
+  std::cout << "mapped: tests passed" << std::endl;
+
+  return 0;
+}
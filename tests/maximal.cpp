@@ -50,6 +50,20 @@ int main(int argc, const char* argv[]) {
   assert(num_species(gm1) == num_species(gm2));
   assert(num_characters(gm2) == num_characters(gm1) + 1);
 
+  MaximalCharacters mc(g);
+
+  assert(mc.characters(g) == cm_check);
+  assert(mc.is_maximal("c2") && mc.is_maximal("c3"));
+  assert(!mc.is_maximal("c4") && !mc.is_maximal("c5"));
+
+  clear_vertex(c3, g);
+
+  std::list<std::string> new_cm = mc.update({"c3"}, g);
+
+  assert(new_cm == std::list<std::string>{"c5"});
+  assert(!mc.is_maximal("c3"));
+  assert(mc.characters(g) == (std::list<RBVertex>{c2, c5}));
+
   std::cout << "maximal: tests passed" << std::endl;
 
   return 0;
@@ -0,0 +1,83 @@
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  HDGraph hasse;
+  RBGraph g;
+
+  read_graph("tests/test_5x2.txt", g);
+  RBGraph gm = maximal_reducible_graph(g);
+  hasse_diagram(hasse, g, gm);
+
+  std::list<HDVertex> discovered, sources;
+
+  HDVertexIter v, v_end;
+  std::tie(v, v_end) = vertices(hasse);
+  for (; v != v_end; ++v) {
+    discovered.push_back(*v);
+  }
+
+  // the order in which the vertices were found is kept
+  sources = discovered;
+  order_sources(sources, hasse);
+
+  assert(sources == discovered);
+
+  // most characters first, ties in the order they were found
+  ordering::policy = ordering::Policy::characters;
+  sources = discovered;
+  order_sources(sources, hasse);
+
+  assert(hasse[sources.front()].characters.size() == 2);
+
+  discovered.remove(sources.front());
+  sources.pop_front();
+
+  assert(sources == discovered);
+
+  // g has no active characters: every vertex has the same priority
+  ordering::policy = ordering::Policy::active;
+  sources = discovered;
+  order_sources(sources, hasse);
+
+  assert(sources == discovered);
+
+  // two sources connected to active characters: test 3 finds both of them
+  // when they are going to be reordered, only the first one otherwise
+  RBGraph g2;
+  add_vertex("s0", Type::species, g2);
+  add_vertex("s1", Type::species, g2);
+
+  for (const auto& c : {"c0", "c1", "c2", "c3"}) {
+    add_vertex(c, Type::character, g2);
+  }
+
+  add_edge(get_vertex("s0", g2), get_vertex("c0", g2), g2);
+  add_edge(get_vertex("s0", g2), get_vertex("c1", g2), Color::red, g2);
+  add_edge(get_vertex("s1", g2), get_vertex("c2", g2), g2);
+  add_edge(get_vertex("s1", g2), get_vertex("c3", g2), Color::red, g2);
+
+  HDGraph hasse2;
+  hasse_diagram(hasse2, g2, g2);
+
+  std::tie(v, v_end) = vertices(hasse2);
+  sources.assign(v, v_end);
+
+  assert(sources.size() == 2);
+  assert(safe_source_test3(sources, hasse2).size() == 2);
+
+  ordering::policy = ordering::Policy::discovery;
+
+  assert(safe_source_test3(sources, hasse2).size() == 1);
+
+  // the statistics need every safe source, even in discovery order
+  ordering::stats = true;
+
+  assert(safe_source_test3(sources, hasse2).size() == 2);
+
+  ordering::stats = false;
+
+  std::cout << "ordering: tests passed" << std::endl;
+
+  return 0;
+}
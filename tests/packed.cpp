@@ -0,0 +1,93 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "matrix.hpp"
+
+/**
+  @brief Return the error message of unpacking \e data, or "" if it is a
+         well-formed packed matrix
+*/
+std::string unpack_error(const std::string& data) {
+  Matrix m;
+
+  try {
+    unpack_matrix(data.data(), data.size(), m);
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+
+  return "";
+}
+
+int main(int argc, const char* argv[]) {
+  Matrix m1, m2;
+  read_matrix("tests/test_6x3.txt", m1);
+
+  // packed matrix: header and one word per row
+  std::ostringstream packed;
+  pack_matrix(packed, m1);
+
+  const auto data = packed.str();
+
+  assert(data.size() == 32 + 6 * 8);
+  assert(is_packed(data.data(), data.size()));
+
+  unpack_matrix(data.data(), data.size(), m2);
+
+  assert(m2.species == 6 && m2.characters == 3);
+  assert(m2.ones == m1.ones);
+  assert(m2.reds.empty());
+
+  // text matrix
+  std::ostringstream text;
+  write_matrix(text, m1);
+
+  assert(text.str().substr(0, 10) == "6 3\n0 0 1\n");
+  assert(!is_packed(text.str().data(), text.str().size()));
+
+  // read_graph detects the format
+  const std::string file = "tests/packed.tmp";
+  std::ofstream(file, std::ios::binary) << data;
+
+  RBGraph g1, g2;
+  read_graph(file, g1);
+  read_graph("tests/test_6x3.txt", g2);
+
+  assert(fingerprint(g1) == fingerprint(g2));
+
+  std::remove(file.c_str());
+
+  // errors
+  const std::string prefix = "Failed to read graph from file: ";
+
+  auto bad = data;
+  bad[4] = 2;
+
+  assert(unpack_error(bad) == prefix + "unsupported packed version 2");
+  assert(unpack_error(data.substr(0, 20)) ==
+         prefix + "truncated packed header");
+  assert(unpack_error(data.substr(0, data.size() - 8)) ==
+         prefix + "undersized matrix");
+  assert(unpack_error(data + "0") == prefix + "oversized matrix");
+
+  // a bit after the last character
+  bad = data;
+  bad[32] |= 8;
+
+  assert(unpack_error(bad) == prefix + "unexpected value in matrix");
+
+  // a red edge plane
+  bad = data + data.substr(32);
+  bad[24] = 1;
+
+#ifdef DEBUG
+  assert(unpack_error(bad) == "");
+#else
+  assert(unpack_error(bad) == prefix + "unexpected value in matrix");
+#endif
+
+  std::cout << "packed: tests passed" << std::endl;
+
+  return 0;
+}
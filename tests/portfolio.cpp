@@ -0,0 +1,35 @@
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g1, g2;
+  std::vector<Strategy> strategies;
+
+  // default, nth source and random source alternated
+  strategies = portfolio_strategies(4);
+
+  assert(strategies.size() == 4);
+  assert(strategies[0].nth == 0 && !strategies[0].random);
+  assert(strategies[1].nth == 1 && !strategies[1].random);
+  assert(strategies[2].random && strategies[2].seed == 1);
+  assert(strategies[3].nth == 2 && !strategies[3].random);
+
+  read_graph("tests/test_5x2.txt", g1);
+  auto output = try_reduce_portfolio(g1, strategies);
+
+  assert(output.second);
+  assert(output.first.size() == 3);
+
+  // the input graph is not modified
+  assert(num_vertices(g1) == 7);
+
+  read_graph("tests/test_6x3.txt", g2);
+  output = try_reduce_portfolio(g2, strategies);
+
+  assert(!output.second);
+  assert(output.first.empty());
+
+  std::cout << "portfolio: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include "pool.hpp"
+#include <cassert>
+#include <iostream>
+
+int main(int argc, const char* argv[]) {
+  BoundedQueue<size_t> queue(2);
+
+  assert(queue.capacity() == 2);
+  assert(queue.push(1));
+  assert(queue.push(2));
+  assert(queue.size() == 2);
+
+  // the producer waits until the consumer makes room: until an item is
+  // popped, the push can't complete, however the threads are scheduled
+  std::atomic<bool> started(false), pushed(false);
+  std::thread producer([&queue, &started, &pushed]() {
+    started = true;
+    assert(queue.push(3));
+    pushed = true;
+  });
+
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  assert(!pushed);
+  assert(queue.size() == 2);
+
+  size_t item;
+  assert(queue.pop(item) && item == 1);
+
+  producer.join();
+  assert(pushed);
+  assert(queue.size() == 2);
+
+  // a closed queue rejects new items, but drains the queued ones
+  queue.close();
+
+  assert(!queue.push(4));
+  assert(queue.pop(item) && item == 2);
+  assert(queue.pop(item) && item == 3);
+  assert(!queue.pop(item));
+
+  // items flow in order through a queue smaller than the stream
+  BoundedQueue<size_t> stream(3);
+  std::thread writer([&stream]() {
+    for (size_t i = 0; i < 1000; ++i) {
+      stream.push(i);
+    }
+
+    stream.close();
+  });
+
+  size_t count = 0;
+  while (stream.pop(item)) {
+    assert(item == count);
+    assert(stream.size() <= stream.capacity());
+
+    count++;
+  }
+
+  writer.join();
+  assert(count == 1000);
+
+  std::cout << "queue: tests passed" << std::endl;
+
+  return 0;
+}
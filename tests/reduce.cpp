@@ -0,0 +1,72 @@
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g, g1, g2, g3;
+  std::list<SignedCharacter> output;
+  bool success;
+
+  read_graph("tests/test_5x2.txt", g);
+  read_graph("tests/test_6x3.txt", g1);
+  copy_graph(g1, g2);
+
+  std::tie(output, success) = try_reduce(g);
+
+  assert(success);
+  assert(!output.empty());
+  assert(is_empty(g));
+
+  std::tie(output, success) = try_reduce(g1);
+
+  assert(!success);
+  assert(output.empty());
+
+  bool thrown = false;
+
+  try {
+    reduce(g2);
+  } catch (const NoReduction& e) {
+    thrown = true;
+  }
+
+  assert(thrown);
+
+  read_graph("tests/test_5x2.txt", g3);
+  MaximalCharacters cm(g3);
+  RBGraph gm = maximal_reducible_graph(g3, cm.characters(g3));
+  cm.prune(gm);
+
+  output = reduce(gm, cm);
+
+  assert(!output.empty());
+  assert(is_empty(gm));
+
+  // exponential algorithm, stopped at the first successful safe source
+  exponential::enabled = true;
+  exponential::first_success = true;
+
+  RBGraph g4;
+  read_graph("tests/test_5x2.txt", g4);
+  std::tie(output, success) = try_reduce(g4);
+
+  assert(success);
+  assert(!output.empty());
+
+  // a cancelled branch fails immediately
+  CancellationToken token;
+  token.cancel();
+  branch_cancellation() = &token;
+
+  RBGraph g5;
+  read_graph("tests/test_5x2.txt", g5);
+  std::tie(output, success) = try_reduce(g5);
+
+  assert(!success);
+  assert(!is_empty(g5));
+
+  branch_cancellation() = nullptr;
+
+  std::cout << "reduce: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdlib>
+#include "functions.hpp"
+
+
+int main(int argc, const char* argv[]) {
+  RBGraph g1, g2;
+  ShardQueue queue({{0}, {1}, {2, 0}}, 16);
+  SharedHashSet set(8);
+  size_t index;
+  int status;
+
+  assert(queue.size() == 3);
+  assert(queue.path(2) == std::vector<uint32_t>({2, 0}));
+
+  // the children see the same queue and set as their parent
+  pid_t pid = fork();
+  if (pid == 0) {
+    queue.pop(getpid(), index);
+    queue.publish(index, "a very long outcome");
+    set.insert(SharedHashSet::key("s0:-c1;"));
+    set.insert({42, 1});
+
+    _exit(0);
+  }
+
+  waitpid(pid, &status, 0);
+
+  assert(queue.state(0) == ShardQueue::done);
+  assert(queue.outcome(0) == "a very long outc");
+  assert(set.contains(SharedHashSet::key("s0:-c1;")));
+  assert(!set.contains(SharedHashSet::key("s0:+c1;")));
+  assert(set.contains({42, 1}));
+  assert(!set.contains({43, 1}));
+
+  // a key matches only if both of its hashes do
+  assert(!set.contains({42, 2}));
+
+  // the items of a crashed child can be queued again
+  pid = fork();
+  if (pid == 0) {
+    queue.pop(getpid(), index);
+
+    abort();
+  }
+
+  waitpid(pid, &status, 0);
+
+  assert(!WIFEXITED(status));
+  assert(queue.taken_by(pid) == std::vector<size_t>({1}));
+
+  queue.requeue(1);
+
+  assert(queue.state(1) == ShardQueue::pending);
+  assert(queue.pop(getpid(), index) && index == 1);
+
+  // the sharded search finds the reduction of the exponential algorithm
+  exponential::enabled = true;
+
+  read_graph("tests/test_5x2.txt", g1);
+  read_graph("tests/test_5x2.txt", g2);
+
+  const auto output = try_reduce(g1);
+
+  transposition_table().clear();
+
+  // a probe stops at the first choice, which has two safe sources
+  RBGraph g3;
+  read_graph("tests/test_5x2.txt", g3);
+
+  branch_path().probe = true;
+
+  assert(!try_reduce(g3).second);
+  assert(branch_path().width == 2 && transposition_table().size() == 0);
+
+  branch_path() = BranchPath();
+
+  assert(try_reduce_sharded(g2, 2) == output);
+
+  std::cout << "sharded: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "matrix.hpp"
+
+/**
+  @brief Return the error message of parsing the sparse \e text, or "" if it
+         is a well-formed sparse matrix
+*/
+std::string sparse_error(const char* text) {
+  SparseMatrix m;
+
+  try {
+    parse_sparse(text, std::strlen(text), m);
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+
+  return "";
+}
+
+int main(int argc, const char* argv[]) {
+  Matrix m1, m2;
+  read_matrix("tests/test_6x3.txt", m1);
+
+  // sparse matrix: the characters of every species with any
+  std::ostringstream sparse;
+  write_sparse(sparse, m1);
+
+  const auto data = sparse.str();
+
+  assert(data.substr(0, 15) == "sparse 6 3\n0: 2");
+  assert(is_sparse(data.data(), data.size()));
+  assert(!is_sparse("sparsely", 8));
+
+  SparseMatrix m;
+  parse_sparse(data.data(), data.size(), m);
+
+  assert(m.species == 6 && m.characters == 3);
+
+  expand_matrix(m, m2);
+
+  assert(m2.words == 1);
+  assert(m2.ones == m1.ones);
+
+  // read_graph detects the format, and builds the same graph
+  const std::string file = "tests/sparse.tmp";
+  std::ofstream(file, std::ios::binary) << data;
+
+  RBGraph g1, g2, g3;
+  read_graph(file, g1);
+  read_graph("tests/test_6x3.txt", g2);
+  build_graph(m, g3);
+
+  assert(fingerprint(g1) == fingerprint(g2));
+  assert(fingerprint(g3) == fingerprint(g2));
+
+  read_matrix(file, m2);
+
+  assert(m2.ones == m1.ones);
+
+  std::remove(file.c_str());
+
+  // the rows are in any order, empty rows are omitted
+  const char* rows = "sparse 3 70\n2: 69 0\n\n0:  1\t64\r\n";
+  parse_sparse(rows, std::strlen(rows), m);
+
+  assert(m.cells.size() == 4);
+  assert(m.cells[0].species == 0 && m.cells[0].character == 1);
+  assert(m.cells[3].species == 2 && m.cells[3].character == 69);
+
+  expand_matrix(m, m2);
+
+  assert(m2.words == 2);
+  assert(m2.at(0, 64) == 1 && m2.at(1, 3) == 0 && m2.at(2, 69) == 1);
+
+  // errors
+  const std::string prefix = "Failed to read graph from file: ";
+
+  assert(sparse_error("sparse 2 2\n1: 0\n") == "");
+  assert(sparse_error("sparse 2\n1: 0\n") == prefix + "badly formatted line 0");
+  assert(sparse_error("sparse\n") == prefix + "badly formatted line 0");
+  assert(sparse_error("sparse 2 2\n2: 0\n") == prefix + "oversized matrix");
+  assert(sparse_error("sparse 2 2\n1: 2\n") == prefix + "oversized matrix");
+  assert(sparse_error("sparse 2 2\n1 0\n") ==
+         prefix + "unexpected value in matrix");
+  assert(sparse_error("sparse 2 2\n1: x\n") ==
+         prefix + "unexpected value in matrix");
+  assert(sparse_error("sparse 2 2\n1: 0\n1: 0\n") ==
+         prefix + "duplicate value in matrix");
+
+#ifdef DEBUG
+  assert(sparse_error("sparse 2 2\n1: 0*\n") == "");
+#else
+  assert(sparse_error("sparse 2 2\n1: 0*\n") ==
+         prefix + "unexpected value in matrix");
+#endif
+
+  std::cout << "sparse: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+#include "pool.hpp"
+#include <cassert>
+#include <iostream>
+
+size_t fib(ThreadPool& pool, const size_t n) {
+  if (n < 2) return n;
+
+  // the subproblems are tasks of the pool, waited by the calling task
+  auto a = pool.submit([&pool, n]() { return fib(pool, n - 1); });
+  auto b = pool.submit([&pool, n]() { return fib(pool, n - 2); });
+
+  return pool.wait(a) + pool.wait(b);
+}
+
+int main(int argc, const char* argv[]) {
+  ThreadPool pool(4);
+
+  assert(pool.size() == 4);
+
+  std::vector<std::future<size_t>> results;
+  for (size_t i = 0; i < 100; ++i) {
+    results.push_back(pool.submit([i]() { return i * i; }));
+  }
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    assert(pool.wait(results[i]) == i * i);
+  }
+
+  assert(fib(pool, 15) == 610);
+
+  ThreadPool single(1);
+
+  assert(fib(single, 10) == 55);
+
+  CancellationToken parent;
+  CancellationToken child(&parent), sibling(&parent);
+
+  assert(!child.cancelled());
+
+  child.cancel();
+
+  assert(child.cancelled() && !sibling.cancelled() && !parent.cancelled());
+
+  parent.cancel();
+
+  assert(sibling.cancelled());
+
+  std::cout << "threadpool: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <cassert>
+#include "matrix.hpp"
+
+/**
+  @brief Parse \e text with the instruction set \e simd into \e m, returning
+         the error message, or "" if it is a well-formed matrix
+*/
+std::string parse(const std::string& text, const Simd simd, Matrix& m) {
+  try {
+    parse_matrix(text.data(), text.size(), m, simd);
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+
+  return "";
+}
+
+int main(int argc, const char* argv[]) {
+  // 3 rows of 100 cells: the rows span two words, and the vectorized
+  // tokenizer reads the cells in blocks that span the rows
+  std::string text = "3 100\n";
+
+  for (size_t i = 0; i < 300; ++i) {
+    text += (i % 7 == 0 || i % 64 == 63 ? '1' : '0');
+    text += (i % 100 == 99 ? "\r\n" : (i % 11 == 0 ? "\t " : " "));
+  }
+
+  // the cells split by empty lines, or not separated at all
+  std::string split = "3 100\n", packed = "3 100\n";
+
+  for (size_t i = 0; i < 300; ++i) {
+    const char cell = (i % 7 == 0 || i % 64 == 63 ? '1' : '0');
+
+    split += cell;
+    split += (i % 13 == 0 ? "\n\n" : " ");
+    packed += cell;
+  }
+
+  for (const auto simd : {Simd::none, Simd::sse2, Simd::avx2}) {
+    Matrix m1, m2, m3;
+
+    assert(parse(text, simd, m1) == "");
+    assert(parse(split, simd, m2) == "");
+    assert(parse(packed, simd, m3) == "");
+
+    assert(m1.words == 2);
+    assert(m1.ones == m2.ones && m1.ones == m3.ones);
+
+    for (size_t i = 0; i < 300; ++i) {
+      assert(m1.at(i / 100, i % 100) == (i % 7 == 0 || i % 64 == 63 ? 1 : 0));
+    }
+
+    // the errors are found in the order of the cells
+    auto bad = text;
+    bad[bad.size() - 40] = '1';
+    bad += "0 0 0 1";
+
+    assert(parse(bad, simd, m1) ==
+           "Failed to read graph from file: oversized matrix");
+
+    bad[bad.size() - 60] = '-';
+
+    assert(parse(bad, simd, m1) ==
+           "Failed to read graph from file: unexpected value in matrix");
+
+    assert(parse(text + "0", simd, m1) ==
+           "Failed to read graph from file: undersized matrix");
+    assert(parse(text.substr(0, text.size() - 5), simd, m1) ==
+           "Failed to read graph from file: undersized matrix");
+
+#ifdef DEBUG
+    // red edges
+    auto red = text;
+    red[red.size() - 3] = '2';
+
+    assert(parse(red, simd, m1) == "");
+    assert(m1.at(2, 99) == 2);
+#endif
+  }
+
+  std::cout << "tokenizer: tests passed" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,222 @@
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/program_options.hpp>
+#include <cstdio>
+#include <fstream>
+#include "matrix.hpp"
+
+/**
+  @brief Check if \e a and \e b are the same existing file, under any name
+
+  @param[in] a Filename
+  @param[in] b Filename
+
+  @return True if \e a and \e b are the same file
+*/
+bool same_file(const std::string& a, const std::string& b) {
+  struct stat sa, sb;
+
+  if (stat(a.c_str(), &sa) != 0 || stat(b.c_str(), &sb) != 0) return false;
+
+  return sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+}
+
+/**
+  @brief Read from \e input into \e m, naming \e input in the errors
+
+  @param[in]  input Filename
+  @param[out] m     Matrix
+
+  @throw std::runtime_error if \e input is not a well-formed matrix
+*/
+void read_input(const std::string& input, Matrix& m) {
+  try {
+    read_matrix(input, m);
+  } catch (const std::runtime_error& e) {
+    // the reason follows the "Failed to read graph from file: " prefix
+    std::string reason = e.what();
+    const auto colon = reason.find(": ");
+    if (colon != std::string::npos) reason.erase(0, colon + 2);
+
+    throw std::runtime_error("Failed to read matrix from file " + input + ": " +
+                             reason);
+  }
+}
+
+/**
+  @brief Create an empty temporary file next to \e output, with the
+         permissions a new \e output would have
+
+  @param[in] output Filename
+
+  @return Filename of the temporary file
+
+  @throw std::runtime_error if the file can't be created
+*/
+std::string temporary_file(const std::string& output) {
+  std::string name = output + ".XXXXXX";
+
+  const int fd = mkstemp(&name[0]);
+
+  if (fd == -1) {
+    // output directory can't be written
+    throw std::runtime_error("Failed to write matrix to file: " + output);
+  }
+
+  // mkstemp creates the file readable by its owner only
+  const mode_t mask = umask(0);
+  umask(mask);
+  fchmod(fd, 0666 & ~mask);
+  close(fd);
+
+  return name;
+}
+
+int main(int argc, const char* argv[]) {
+  // declare the input and output files
+  std::vector<std::string> files;
+  std::string format;
+
+  // initialize options menu
+  boost::program_options::options_description general_options(
+      "Usage: ppp-convert [OPTION...] INPUT... OUTPUT"
+      "\n"
+      "Convert the matrix in INPUT (in any format) to OUTPUT, or collect the "
+      "matrices in INPUT(s) in the container OUTPUT."
+      "\n\n"
+      "Options");
+
+  general_options.add_options()
+      // option: help message
+      ("help,h", "Display this message.\n")
+      // option: to, format of the output file
+      ("to,t",
+       boost::program_options::value<std::string>(&format)->default_value(
+           "packed"),
+       "Format of OUTPUT: text (space-separated values), packed (binary, "
+       "one bit per cell), sparse (character indices of every species) or "
+       "container (packed matrices, with an index).\n");
+
+  // initialize hidden options (not shown in --help)
+  boost::program_options::options_description hidden_options;
+  // option: input and output files
+  hidden_options.add_options()(
+      "files", boost::program_options::value<std::vector<std::string>>(&files));
+
+  // initialize positional options
+  boost::program_options::positional_options_description positional_options;
+  positional_options.add("files", -1);
+
+  // initialize options
+  boost::program_options::options_description cmdline_options;
+  cmdline_options.add(general_options).add(hidden_options);
+
+  // initialize the variables map
+  boost::program_options::variables_map vm;
+
+  try {
+    boost::program_options::store(
+        boost::program_options::command_line_parser(argc, argv)
+            .positional(positional_options)
+            .options(cmdline_options)
+            .run(),
+        vm);
+
+    boost::program_options::notify(vm);
+
+    if (format != "text" && format != "packed" && format != "sparse" &&
+        format != "container") {
+      throw std::logic_error("unknown format '" + format + "'");
+    }
+
+    if (format != "container" && files.size() > 2) {
+      throw std::logic_error("only one INPUT can be converted to " + format);
+    }
+  } catch (const std::exception& e) {
+    // error while parsing the options given in input
+    std::cerr << "Error: " << e.what() << "." << std::endl
+              << "Try '" << argv[0] << " --help' for more information."
+              << std::endl;
+
+    return 1;
+  }
+
+  if (vm.count("help")) {
+    // help option specified
+    std::cerr << general_options << std::endl;
+
+    return 1;
+  }
+
+  if (files.size() < 2) {
+    // no input or output file specified
+    std::cerr << "Error: No input or output file specified." << std::endl
+              << "Try '" << argv[0] << " --help' for more information."
+              << std::endl;
+
+    return 1;
+  }
+
+  const std::string output = files.back();
+  files.pop_back();
+
+  for (const auto& input : files) {
+    if (same_file(input, output)) {
+      // OUTPUT would be truncated before INPUT is read
+      std::cerr << "Error: OUTPUT " << output << " is also an INPUT."
+                << std::endl;
+
+      return 1;
+    }
+  }
+
+  // OUTPUT is written in a temporary file, renamed once every INPUT has been
+  // converted, so a failure never leaves a partial OUTPUT behind
+  std::string temporary;
+
+  try {
+    Matrix m;
+
+    if (format != "container") read_input(files.front(), m);
+
+    temporary = temporary_file(output);
+
+    std::ofstream file(temporary, std::ios::binary);
+
+    if (!file) {
+      // output file can't be created
+      throw std::runtime_error("Failed to write matrix to file: " + output);
+    }
+
+    if (format == "container") {
+      ContainerWriter container(file);
+
+      for (const auto& input : files) {
+        read_input(input, m);
+        container.add(input, m);
+      }
+
+      container.close();
+    } else if (format == "packed") {
+      pack_matrix(file, m);
+    } else if (format == "sparse") {
+      write_sparse(file, m);
+    } else {
+      write_matrix(file, m);
+    }
+
+    file.close();
+
+    if (!file || std::rename(temporary.c_str(), output.c_str()) != 0) {
+      throw std::runtime_error("Failed to write matrix to file: " + output);
+    }
+  } catch (const std::exception& e) {
+    if (!temporary.empty()) std::remove(temporary.c_str());
+
+    std::cerr << "Error: " << e.what() << "." << std::endl;
+
+    return 1;
+  }
+
+  return 0;
+}